@@ -101,7 +101,7 @@ int main(int argc, char **argv) {
 		exit(EXIT_FAILURE);
 	}
 
-	int8_t ret = barelog_host_init(my_platform, my_init, my_read, my_write,
+	int32_t ret = barelog_host_init(my_platform, my_init, my_read, my_write,
 		my_finalize);
 	if (ret != 16) {
 		print_trace(TRACE_ERROR, "barelog_init error");
@@ -190,6 +190,8 @@ int main(int argc, char **argv) {
 			fprintf(stderr, " * %u %s\n", j,
 				res_buffer[i].buffer[j]);
 		}
+		barelog_result_free(&(res_buffer[i]));
+		free(events_buff);
 	}
 
 	fprintf(stderr, "\nBARELOG_DEBUG :\n");
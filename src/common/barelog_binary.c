@@ -0,0 +1,470 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#include "barelog_binary.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+/* Length modifiers of a conversion specification. */
+typedef enum {
+	LEN_NONE,
+	LEN_HH,
+	LEN_H,
+	LEN_L,
+	LEN_LL,
+	LEN_J,
+	LEN_Z,
+	LEN_T,
+	LEN_BIG_L
+} length_modifier_t;
+
+/* Kind of value stored for a conversion specification. */
+typedef enum {
+	ARG_NONE,
+	ARG_INT,
+	ARG_LONG,
+	ARG_DOUBLE,
+	ARG_POINTER,
+	ARG_STRING,
+	ARG_INVALID
+} arg_class_t;
+
+/* Parsed conversion specification (everything between '%' and the
+ * conversion character, both included). */
+typedef struct {
+	const char *flags;
+	uint8_t flags_length;
+	const char *width;
+	uint8_t width_length;
+	uint8_t width_star;
+	uint8_t has_precision;
+	const char *precision;
+	uint8_t precision_length;
+	uint8_t precision_star;
+	length_modifier_t length;
+	char conversion;
+	arg_class_t arg;
+} conversion_spec_t;
+
+/* Size (in bytes) of the stored integers and 8 bytes values. */
+#define INT_SIZE sizeof(int32_t)
+#define LONG_SIZE sizeof(int64_t)
+
+/* Maximum length of a rebuilt conversion specification. */
+#define SPEC_MAX_SIZE 48
+
+/*
+ * Parses the conversion specification beginning right after a '%'.
+ * Returns a pointer to the character following the specification.
+ */
+static inline const char *parse_spec(const char *p, conversion_spec_t *spec) {
+	spec->flags = p;
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') {
+		++p;
+	}
+	spec->flags_length = p - spec->flags;
+
+	spec->width = p;
+	spec->width_star = (*p == '*');
+	if (spec->width_star) {
+		++p;
+	} else {
+		while (*p >= '0' && *p <= '9') {
+			++p;
+		}
+	}
+	spec->width_length = p - spec->width;
+
+	spec->has_precision = (*p == '.');
+	spec->precision_star = 0;
+	spec->precision_length = 0;
+	if (spec->has_precision) {
+		spec->precision = ++p;
+		spec->precision_star = (*p == '*');
+		if (spec->precision_star) {
+			++p;
+		} else {
+			while (*p >= '0' && *p <= '9') {
+				++p;
+			}
+		}
+		spec->precision_length = p - spec->precision;
+	}
+
+	spec->length = LEN_NONE;
+	switch (*p) {
+	case 'h':
+		spec->length = (p[1] == 'h') ? LEN_HH : LEN_H;
+		p += (p[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		spec->length = (p[1] == 'l') ? LEN_LL : LEN_L;
+		p += (p[1] == 'l') ? 2 : 1;
+		break;
+	case 'q':
+		spec->length = LEN_LL;
+		++p;
+		break;
+	case 'j':
+		spec->length = LEN_J;
+		++p;
+		break;
+	case 'z':
+		spec->length = LEN_Z;
+		++p;
+		break;
+	case 't':
+		spec->length = LEN_T;
+		++p;
+		break;
+	case 'L':
+		spec->length = LEN_BIG_L;
+		++p;
+		break;
+	default:
+		break;
+	}
+
+	spec->conversion = *p;
+	switch (*p) {
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		spec->arg = (spec->length >= LEN_L && spec->length <= LEN_T) ?
+			ARG_LONG : ARG_INT;
+		break;
+	case 'c':
+		spec->arg = ARG_INT;
+		break;
+	case 'e':
+	case 'E':
+	case 'f':
+	case 'F':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec->arg = ARG_DOUBLE;
+		break;
+	case 'p':
+		spec->arg = ARG_POINTER;
+		break;
+	case 's':
+		spec->arg = ARG_STRING;
+		break;
+	case 'n':
+	case '%':
+		spec->arg = ARG_NONE;
+		break;
+	default:
+		spec->arg = ARG_INVALID;
+		return p;
+	}
+
+	return p + 1;
+}
+
+/* Appends n bytes to the encoded arguments, unless they or a previous
+ * argument do not fit : the bytes are then only counted as needed. */
+static inline void encode_put(char *buffer, size_t size, size_t *pos,
+	size_t *needed, const void *data, size_t n) {
+	if (*pos == *needed && *pos + n <= size) {
+		memcpy(buffer + *pos, data, n);
+		*pos += n;
+	}
+	*needed += n;
+}
+
+size_t barelog_binary_vencode(char *buffer, size_t size, const char *format,
+	va_list ap, size_t *needed) {
+	conversion_spec_t spec = { .arg = ARG_NONE };
+	size_t pos = 0;
+	size_t total = 0;
+	int32_t i32 = 0;
+	int64_t i64 = 0;
+	double d = 0;
+
+	const char *p = format;
+	while (*p && spec.arg != ARG_INVALID) {
+		if (*p++ != '%') {
+			continue;
+		}
+		p = parse_spec(p, &spec);
+
+		if (spec.width_star) {
+			i32 = va_arg(ap, int);
+			encode_put(buffer, size, &pos, &total, &i32, INT_SIZE);
+		}
+		if (spec.precision_star) {
+			i32 = va_arg(ap, int);
+			encode_put(buffer, size, &pos, &total, &i32, INT_SIZE);
+		}
+
+		switch (spec.arg) {
+		case ARG_NONE:
+			if (spec.conversion == 'n') {
+				(void) va_arg(ap, void *);
+			}
+			break;
+		case ARG_INT:
+			i32 = va_arg(ap, int);
+			encode_put(buffer, size, &pos, &total, &i32, INT_SIZE);
+			break;
+		case ARG_LONG:
+			if (spec.conversion == 'd' || spec.conversion == 'i') {
+				switch (spec.length) {
+				case LEN_L: i64 = va_arg(ap, long); break;
+				case LEN_LL: i64 = va_arg(ap, long long); break;
+				case LEN_J: i64 = va_arg(ap, intmax_t); break;
+				case LEN_Z: i64 = va_arg(ap, size_t); break;
+				default: i64 = va_arg(ap, ptrdiff_t); break;
+				}
+			} else {
+				switch (spec.length) {
+				case LEN_L: i64 = va_arg(ap, unsigned long); break;
+				case LEN_LL: i64 = va_arg(ap, unsigned long long); break;
+				case LEN_J: i64 = va_arg(ap, uintmax_t); break;
+				case LEN_Z: i64 = va_arg(ap, size_t); break;
+				default: i64 = va_arg(ap, ptrdiff_t); break;
+				}
+			}
+			encode_put(buffer, size, &pos, &total, &i64, LONG_SIZE);
+			break;
+		case ARG_DOUBLE:
+			d = (spec.length == LEN_BIG_L) ?
+				(double) va_arg(ap, long double) : va_arg(ap, double);
+			encode_put(buffer, size, &pos, &total, &d, LONG_SIZE);
+			break;
+		case ARG_POINTER:
+			i64 = (int64_t) (uintptr_t) va_arg(ap, void *);
+			encode_put(buffer, size, &pos, &total, &i64, LONG_SIZE);
+			break;
+		case ARG_STRING: {
+			const char *s = va_arg(ap, const char *);
+			if (!s) {
+				s = "(null)";
+			}
+			const size_t n = strlen(s);
+			/* Strings are truncated to fit in the remaining space. */
+			if (pos == total && pos < size) {
+				const size_t kept = (n > size - pos - 1) ? size - pos - 1 : n;
+				memcpy(buffer + pos, s, kept);
+				buffer[pos + kept] = '\0';
+				pos += kept + 1;
+				total += kept + 1;
+				if (kept < n) {
+					/* Stops the writing of the following arguments. */
+					total += n - kept;
+				}
+			} else {
+				total += n + 1;
+			}
+			break;
+		}
+		default:
+			/* The decoding stops at the same point. */
+			break;
+		}
+	}
+
+	if (needed) {
+		*needed = total;
+	}
+
+	return pos;
+}
+
+/*
+ * Rebuilds a conversion specification usable by the host's snprintf :
+ * '*' are replaced by the stored values and length modifiers are adapted to
+ * the size of the stored values.
+ */
+static inline int8_t rebuild_spec(char *out, const conversion_spec_t *spec,
+	const char **args, const char *args_end) {
+	char *o = out;
+	int32_t star = 0;
+
+	*o++ = '%';
+	memcpy(o, spec->flags, spec->flags_length);
+	o += spec->flags_length;
+
+	if (spec->width_star) {
+		if (*args + INT_SIZE > args_end) {
+			return BARELOG_ERR;
+		}
+		memcpy(&star, *args, INT_SIZE);
+		*args += INT_SIZE;
+		o += sprintf(o, "%"PRId32, star);
+	} else {
+		memcpy(o, spec->width, spec->width_length);
+		o += spec->width_length;
+	}
+
+	if (spec->precision_star) {
+		if (*args + INT_SIZE > args_end) {
+			return BARELOG_ERR;
+		}
+		memcpy(&star, *args, INT_SIZE);
+		*args += INT_SIZE;
+		/* A negative precision is taken as if it was omitted. */
+		if (star >= 0) {
+			o += sprintf(o, ".%"PRId32, star);
+		}
+	} else if (spec->has_precision) {
+		*o++ = '.';
+		memcpy(o, spec->precision, spec->precision_length);
+		o += spec->precision_length;
+	}
+
+	if (spec->arg == ARG_LONG) {
+		*o++ = 'l';
+		*o++ = 'l';
+	} else if (spec->arg == ARG_INT && spec->conversion != 'c') {
+		if (spec->length == LEN_H || spec->length == LEN_HH) {
+			*o++ = 'h';
+		}
+		if (spec->length == LEN_HH) {
+			*o++ = 'h';
+		}
+	}
+
+	*o++ = spec->conversion;
+	*o = '\0';
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t barelog_binary_decode(char *buffer, size_t size, const char *format,
+	const char *args, size_t args_size) {
+#if BARELOG_CHECK_MODE
+	if (!buffer || !format || (!args && args_size)) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	const char *args_end = args + args_size;
+	conversion_spec_t spec;
+	char spec_buffer[SPEC_MAX_SIZE];
+	size_t pos = 0;
+	int ret = 0;
+	int32_t i32 = 0;
+	int64_t i64 = 0;
+	double d = 0;
+
+	const char *p = format;
+	while (*p) {
+		/* Copies the literal part of the format. */
+		const char *literal = p;
+		while (*p && *p != '%') {
+			++p;
+		}
+		if (p > literal) {
+			if (pos < size) {
+				size_t n = p - literal;
+				memcpy(buffer + pos, literal, (n < size - pos) ? n : size - pos);
+			}
+			pos += p - literal;
+			continue;
+		}
+
+		const char *spec_end = parse_spec(p + 1, &spec);
+		if (spec.arg == ARG_INVALID
+			|| spec.flags_length + spec.width_length + spec.precision_length + 8 > SPEC_MAX_SIZE
+			|| rebuild_spec(spec_buffer, &spec, &args, args_end) != BARELOG_SUCCESS) {
+			break;
+		}
+
+		char *out = (pos < size) ? buffer + pos : NULL;
+		size_t out_size = (pos < size) ? size - pos : 0;
+
+		switch (spec.arg) {
+		case ARG_NONE:
+			ret = (spec.conversion == '%') ? snprintf(out, out_size, "%%") : 0;
+			break;
+		case ARG_INT:
+			if (args + INT_SIZE > args_end) {
+				goto end;
+			}
+			memcpy(&i32, args, INT_SIZE);
+			args += INT_SIZE;
+			ret = snprintf(out, out_size, spec_buffer, i32);
+			break;
+		case ARG_LONG:
+			if (args + LONG_SIZE > args_end) {
+				goto end;
+			}
+			memcpy(&i64, args, LONG_SIZE);
+			args += LONG_SIZE;
+			ret = snprintf(out, out_size, spec_buffer, (long long) i64);
+			break;
+		case ARG_DOUBLE:
+			if (args + LONG_SIZE > args_end) {
+				goto end;
+			}
+			memcpy(&d, args, LONG_SIZE);
+			args += LONG_SIZE;
+			ret = snprintf(out, out_size, spec_buffer, d);
+			break;
+		case ARG_POINTER:
+			if (args + LONG_SIZE > args_end) {
+				goto end;
+			}
+			memcpy(&i64, args, LONG_SIZE);
+			args += LONG_SIZE;
+			ret = snprintf(out, out_size, spec_buffer, (void *) (uintptr_t) i64);
+			break;
+		case ARG_STRING: {
+			const char *s = args;
+			while (args < args_end && *args) {
+				++args;
+			}
+			if (args >= args_end) {
+				goto end;
+			}
+			++args;
+			ret = snprintf(out, out_size, spec_buffer, s);
+			break;
+		}
+		default:
+			goto end;
+		}
+
+		if (ret < 0) {
+			return BARELOG_EVENT_CONVERSION_ERR;
+		}
+		pos += ret;
+		p = spec_end;
+	}
+
+end:
+	if (size) {
+		buffer[(pos < size) ? pos : size - 1] = '\0';
+	}
+
+	return pos;
+}
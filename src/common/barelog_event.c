@@ -33,9 +33,77 @@
 const barelog_event_t BARELOG_EVENT_INITIALIZER = {
 	.timestamp = 0,
 	.core = 0,
+	.length = 0,
+	.sequence = 0,
+	.level = 0,
+	.flags = 0,
 	.data = ""
 };
 
+#if BARELOG_BINARY_MODE
+static const char *(*format_resolver)(uint32_t core, uint64_t format_id) = NULL;
+static const barelog_site_t *(*site_resolver)(uint32_t core, uint16_t site_id) = NULL;
+
+void barelog_set_format_resolver(const char *(*resolver)(uint32_t core, uint64_t format_id)) {
+	format_resolver = resolver;
+}
+
+void barelog_set_site_resolver(const barelog_site_t *(*resolver)(uint32_t core, uint16_t site_id)) {
+	site_resolver = resolver;
+}
+
+int8_t barelog_event_to_string(const barelog_event_t event, char *buffer) {
+	const char *format = NULL;
+	uint64_t id = 0;
+	size_t header_size = 0;
+
+	switch (event.data[0]) {
+	case BARELOG_BINARY_FORMAT_TAG: {
+		uint32_t format_id = 0;
+		memcpy(&format_id, &event.data[1], sizeof(uint32_t));
+		id = format_id;
+		format = (format_resolver) ? format_resolver(event.core, id) : NULL;
+		header_size = BARELOG_BINARY_FORMAT_HEADER_SIZE;
+		break;
+	}
+	case BARELOG_BINARY_FORMAT64_TAG:
+		memcpy(&id, &event.data[1], sizeof(uint64_t));
+		format = (format_resolver) ? format_resolver(event.core, id) : NULL;
+		header_size = BARELOG_BINARY_FORMAT64_HEADER_SIZE;
+		break;
+	case BARELOG_BINARY_SITE_TAG: {
+		uint16_t site_id = 0;
+		memcpy(&site_id, &event.data[1], sizeof(uint16_t));
+		const barelog_site_t *site = (site_resolver) ? site_resolver(event.core, site_id) : NULL;
+		format = (site) ? site->format : NULL;
+		id = site_id;
+		header_size = BARELOG_BINARY_SITE_HEADER_SIZE;
+		break;
+	}
+	default:
+		return BARELOG_EVENT_CONVERSION_ERR;
+	}
+
+	int ret = snprintf(buffer, EVENT_TO_STRING_SIZE, "%"PRIu64" %"PRIu32" ",
+			event.timestamp, event.core);
+	if (ret < 0 || ret >= EVENT_TO_STRING_SIZE) {
+		return BARELOG_EVENT_CONVERSION_ERR;
+	}
+
+	if (!format) {
+		snprintf(buffer + ret, EVENT_TO_STRING_SIZE - ret,
+			(event.data[0] == BARELOG_BINARY_SITE_TAG) ? "<site %"PRIu64">" : "<format 0x%08"PRIx64">", id);
+		return BARELOG_SUCCESS;
+	}
+
+	if (barelog_binary_decode(buffer + ret, EVENT_TO_STRING_SIZE - ret, format,
+		&event.data[header_size], BARELOG_BUF_MAX_SIZE - header_size) < 0) {
+		return BARELOG_EVENT_CONVERSION_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+#else
 int8_t barelog_event_to_string(const barelog_event_t event, char *buffer) {
 #if BARELOG_CHECK_MODE
 	if (strlen(event.data) > EVENT_TO_STRING_SIZE) {
@@ -43,43 +111,73 @@ int8_t barelog_event_to_string(const barelog_event_t event, char *buffer) {
 	}
 #endif
 
-	return snprintf(buffer, EVENT_TO_STRING_SIZE, "%"PRIu32" %"PRIu32" %s",
+	return snprintf(buffer, EVENT_TO_STRING_SIZE, "%"PRIu64" %"PRIu32" %s",
 			event.timestamp, event.core, event.data);
 }
+#endif // BARELOG_BINARY_MODE
 
-// On suppose que tous les sous-buffers (buffer[i]) font la meme taille => pourrait devenir dynamique avec parametre strlen(event.data)
 int8_t barelog_events_to_strings(const barelog_event_t *events, size_t n, barelog_result_buffer_t *res) {
 #if BARELOG_CHECK_MODE
-	if (n < 0) {
-		return BARELOG_INCONSISTENT_PARAM_ERR;
-	}
-	if (!res) {
+	if (!res || (!events && n)) {
 		return BARELOG_UNINITIALIZED_PARAM_ERR;
 	}
 #endif
 
-	res->buffer = calloc(n, sizeof(char *));
+	/* The strings are packed after the array : the arena is allocated for
+	 * the longest strings, then shrunk to the size actually used. */
+	const size_t array_size = n * sizeof(char *);
+	char *arena = malloc(array_size + n * EVENT_TO_STRING_SIZE + 1);
 
 #if BARELOG_CHECK_MODE
-	if (res->buffer == NULL) {
+	if (arena == NULL) {
 		return BARELOG_ERR;
 	}
 #endif
+	res->buffer = (char **) arena;
 	res->buffer_length = n;
 	res->sub_buffer_length = EVENT_TO_STRING_SIZE;
 
-	int8_t ret = 0;
-	(void) ret;
-	for (uint32_t i = 0; i < n; ++i) {
-		res->buffer[i] = (char *)calloc(EVENT_TO_STRING_SIZE, sizeof(char));
-		ret = barelog_event_to_string(events[i], res->buffer[i]);
-#if BARELOG_CHECK_MODE
-		if (ret != BARELOG_SUCCESS) {
+	size_t used = array_size;
+	for (size_t i = 0; i < n; ++i) {
+		res->buffer[i] = &(arena[used]);
+		if (barelog_event_to_string(events[i], res->buffer[i]) < 0) {
+			barelog_result_free(res);
 			return BARELOG_EVENT_CONVERSION_ERR;
 		}
-#endif
+		used += strlen(res->buffer[i]) + 1;
+	}
+
+	const uintptr_t base = (uintptr_t) arena;
+	char *shrunk = realloc(arena, used ? used : 1);
+	if (shrunk != NULL && (uintptr_t) shrunk != base) {
+		res->buffer = (char **) shrunk;
+		for (size_t i = 0; i < n; ++i) {
+			res->buffer[i] = shrunk + ((uintptr_t) res->buffer[i] - base);
+		}
 	}
 
-	return ret;
+	return BARELOG_SUCCESS;
 }
 
+void barelog_result_free(barelog_result_buffer_t *res) {
+	if (res == NULL) {
+		return;
+	}
+	free(res->buffer);
+	res->buffer = NULL;
+	res->buffer_length = 0;
+}
+
+void barelog_view_init(barelog_result_view_t *view, const barelog_event_t *events, size_t n) {
+	view->events = events;
+	view->length = n;
+	view->line[0] = '\0';
+}
+
+const char *barelog_view_at(barelog_result_view_t *view, size_t i) {
+	if (i >= view->length || barelog_event_to_string(view->events[i], view->line) < 0) {
+		return NULL;
+	}
+
+	return view->line;
+}
@@ -0,0 +1,133 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_binary.h
+ * @brief Module defining the binary (deferred formatting) encoding of events.
+ *
+ * When BARELOG_BINARY_MODE is enabled, the target does not run any printf-like
+ * function : it only stores an identifier of the format string followed by the
+ * raw values of its arguments. The actual formatting is done afterwards by the
+ * host, using the same format string.
+ *
+ * Encoded arguments layout (no alignment, native endianness) :
+ *  - integers (%d, %i, %u, %o, %x, %X, %c, '*' width/precision) : 4 bytes, or
+ *    8 bytes when a l, ll, j, z or t length modifier is used;
+ *  - floating points (%e, %f, %g, %a and their uppercase versions) : 8 bytes
+ *    (double);
+ *  - pointers (%p) : 8 bytes;
+ *  - strings (%s) : the characters of the string, '\0' included (strings are
+ *    copied since their address is meaningless for the host);
+ *  - %n and %% : nothing.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_BINARY__
+#define __BARELOG_BINARY__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#include "barelog_internal.h"
+
+/** First byte of an event data whose format is identified by its (32 bits)
+ * address. */
+#define BARELOG_BINARY_FORMAT_TAG 0x01
+
+/** Size (in bytes) of the header (tag + format id) of a binary event data. */
+#define BARELOG_BINARY_FORMAT_HEADER_SIZE (1 + sizeof(uint32_t))
+
+/** First byte of an event data whose format is identified by its 64 bits
+ * address (on targets with a wider address space than 32 bits). */
+#define BARELOG_BINARY_FORMAT64_TAG 0x03
+
+/** Size (in bytes) of the header (tag + 64 bits format id) of a binary event data. */
+#define BARELOG_BINARY_FORMAT64_HEADER_SIZE (1 + sizeof(uint64_t))
+
+/** First byte of an event data whose format is identified by a log site. */
+#define BARELOG_BINARY_SITE_TAG 0x02
+
+/** Size (in bytes) of the header (tag + site id) of a binary event data. */
+#define BARELOG_BINARY_SITE_HEADER_SIZE (1 + sizeof(uint16_t))
+
+/** Name of the section of the target's ELF holding the log sites. It must be
+ * a valid C identifier so that the linker provides the __start_ and __stop_
+ * symbols of the section. */
+#define BARELOG_SITE_SECTION "barelog_fmt"
+
+/** Maximum number of log sites of a program (the site ids hold 16 bits). */
+#define BARELOG_MAX_SITES (UINT16_MAX + 1)
+
+/**
+ * Description of a log site (see BARELOG_LOG). The log sites are stored into
+ * the BARELOG_SITE_SECTION section of the target's program and the host
+ * retrieves them from the target's ELF. The id of a site is its index inside
+ * this section.
+ *
+ * The structure is aligned on its size (4 pointers) to ensure that all the
+ * sites are contiguous inside the section, whatever the compiler does.
+ */
+typedef struct __attribute__ ((aligned(4 * sizeof(void *)))) {
+	/** format string of the site */
+	const char *format;
+	/** file in which the site is located */
+	const char *file;
+	/** line of the site */
+	uint32_t line;
+	/** log-level of the site */
+	uint32_t lvl;
+} barelog_site_t;
+
+/**
+ * Encodes the arguments corresponding to a format string.
+ * If the buffer is too small, the encoding stops at the first argument
+ * that does not fit (the decoding will then stop at the same point).
+ * @param buffer buffer in which to store the encoded arguments.
+ * @param size size (in bytes) of the buffer.
+ * @param format the format string (printf-like).
+ * @param ap the arguments to encode.
+ * @param needed (optional) set to the size (in bytes) needed to encode all
+ * the arguments, which is greater than the returned size if the buffer is
+ * too small (as for snprintf()).
+ * @return the number of bytes written into the buffer.
+ */
+extern size_t barelog_binary_vencode(char *buffer, size_t size,
+	const char *format, va_list ap, size_t *needed) __attribute__ ((hot));
+
+/**
+ * Decodes arguments previously encoded by barelog_binary_vencode and formats
+ * them into a string, as snprintf() would have done.
+ * @param buffer buffer in which to store the resulting string.
+ * @param size size (in bytes) of the buffer.
+ * @param format the format string used for the encoding.
+ * @param args the encoded arguments.
+ * @param args_size the size (in bytes) of the encoded arguments.
+ * @return the length of the resulting string, or an error code.
+ */
+extern int32_t barelog_binary_decode(char *buffer, size_t size,
+	const char *format, const char *args, size_t args_size);
+
+#endif /* __BARELOG_BINARY__ */
@@ -40,45 +40,215 @@
 #include "barelog_event.h"
 
 /**
- * Queue of events, used to store the local events into a core
- * local memory.
+ * Queue of records, used to store the local events into a core
+ * local memory. A record is never split : when it does not fit at the end
+ * of the buffer, a BARELOG_RECORD_SKIP record (if there is enough room for
+ * its header) is written and the record is stored at the beginning.
+ * The head and tail are free-running byte counters (they are never reset
+ * nor wrapped), the position inside the buffer being given by
+ * (counter & BARELOG_LOCAL_BUFFER_MASK) and the used size by (head - tail).
  */
 typedef struct {
-	/** buffer containing the events (queue) */
-	barelog_event_t buffer[BARELOG_EVENT_PER_CORE_MAX];
-	/** index of the next position to store an event */
+	/** buffer containing the records (queue) */
+	uint8_t buffer[BARELOG_LOCAL_BUFFER_SIZE] __attribute__ ((aligned(BARELOG_RECORD_ALIGNMENT)));
+	/** counter of the bytes written (next position to store a record) */
 	uint32_t head;
-	/** index of the first position effectively used */
+	/** counter of the bytes released (position of the oldest record) */
 	uint32_t tail;
-	/** indicates whether or not the buffer is full */
-	uint8_t full;
-	/** indicates whether or not the buffer is empty */
-	uint8_t empty;
+	/** number of records inside the buffer */
+	uint32_t count;
 } barelog_event_buffer_t;
 
 /**
  * Structure used to store the events of a logged core, represented
  * by strings and not actual events (for display or treatment purposes).
+ * The array of strings and the strings themselves are stored into a
+ * single allocation (the arena), starting with the array : freeing
+ * buffer releases everything (see barelog_result_free()).
  */
 typedef struct barelog_result_buffer_t_ {
 	/** buffer of events (considered as strings) */
 	char **buffer;
 	/** number of events to consider */
 	size_t buffer_length;
-	/** length of each event */
+	/** maximum length of each event */
 	size_t sub_buffer_length;
 } barelog_result_buffer_t;
 
 /**
- * Structure used to store the events in the shared memory.
+ * Header stored at the beginning of the shared memory, describing its layout
+ * (all the offsets being relative to the beginning of the header). It is
+ * written by the host at its initialization, unless asked to keep a valid
+ * one already there (see host_mem_manager_keep_layout()), and read by the
+ * cores at theirs, so that the number of cores and the size of their rings
+ * are only known at runtime.
+ * If chunk_size is not 0, the records of the cores are not stored into fixed
+ * areas but into chunks taken on demand from a pool shared by all the cores
+ * (see barelog_chunk_pool_t) : the ring of each core is then a chain of
+ * chunks (see barelog_chunk_link_t).
  */
 typedef struct {
-	/** events queue */
-	barelog_event_t *events;
-	/** current index inside the queue */
-	uint32_t index;
-	/** max index */
-	uint32_t imax;
+	/** BARELOG_SHARED_MAGIC (written last) */
+	char magic[8];
+	/** BARELOG_SHARED_VERSION */
+	uint32_t version;
+	/** BARELOG_RECORD_VERSION */
+	uint32_t record_version;
+	/** number of cores logged */
+	uint32_t nb_cores;
+	/** maximum size (in bytes) of the events (BARELOG_EVENT_MAX_SIZE) */
+	uint32_t event_max_size;
+	/** size (in bytes) of the ring of records of each core (a power of two) */
+	uint32_t ring_size;
+	/** distance (in bytes) between the rings of two consecutive cores
+	 * (0 if the records are stored into a pool of chunks) */
+	uint32_t core_size;
+	/** offset and size (in bytes) of the debug section (size 0 if none) */
+	uint32_t debug_offset;
+	uint32_t debug_size;
+	/** offset of the control words of the rings (barelog_shared_ring_t) */
+	uint32_t ring_offset;
+	/** offset of the clock synchronization beacons (barelog_sync_beacon_t) */
+	uint32_t sync_offset;
+	/** offset of the statistics of the cores (barelog_core_stats_t) */
+	uint32_t stats_offset;
+	/** offset of the ring of records of the first core (or of the first chunk) */
+	uint32_t data_offset;
+	/** size (in bytes) of the whole layout */
+	uint32_t size;
+	/** size (in bytes) of the chunks, a power of two (0 if no pool is used) */
+	uint32_t chunk_size;
+	/** number of chunks of the pool */
+	uint32_t nb_chunks;
+	/** offset of the chains of chunks of the cores (ring_size / chunk_size
+	 * links per core) */
+	uint32_t chain_offset;
+	/** offset of the control words of the pool of chunks */
+	uint32_t pool_offset;
+	/** 0 */
+	uint32_t reserved;
+} barelog_shared_header_t;
+
+/**
+ * Link of the chain of chunks of a core. The ring of a core is cut into
+ * segments of chunk_size bytes (a record is never split between two of
+ * them), each one being stored into the chunk given by the link of index
+ * (counter / chunk_size) % (ring_size / chunk_size). The core maps a chunk to
+ * a segment before writing into it, and the chunk goes back to the pool once
+ * the segment is consumed by the host (or overwritten by the core). Both
+ * only change the links while holding the lock of the pool.
+ */
+typedef struct {
+	/** counter of the first byte of the segment stored into the chunk */
+	uint32_t segment;
+	/** index of the chunk in the pool (BARELOG_CHUNK_NONE if none) */
+	uint32_t chunk;
+} barelog_chunk_link_t;
+
+/**
+ * Control words of the pool of chunks shared by the cores, followed in
+ * shared memory by the stack of the indexes of the free chunks. The pool is
+ * used by several cores and the host at once : it is protected by a lock
+ * taken with barelog_test_and_set().
+ */
+typedef struct {
+	/** lock of the pool (0 if free) */
+	uint32_t lock;
+	/** number of free chunks */
+	uint32_t count;
+} barelog_chunk_pool_t;
+
+/**
+ * Control words of the ring of records stored in the shared memory area of
+ * each core, with a single producer (the core) and a single consumer (the
+ * host). As for barelog_event_buffer_t, the counters are free-running byte
+ * counters and a record is never split (see BARELOG_RECORD_SKIP).
+ * The core writes the records and only then publishes them by moving the
+ * head. Before overwriting records that have not been consumed yet, it moves
+ * the oldest counter beyond them, so that the host can drop the records it
+ * might have read while they were overwritten.
+ */
+typedef struct {
+	/** counter of the bytes published by the core (written by the core) */
+	uint32_t head;
+	/** counter of the oldest byte not overwritten (written by the core) */
+	uint32_t oldest;
+	/** counter of the bytes consumed by the host (written by the host) */
+	uint32_t tail;
+	/** unused (keeps the control words of each core aligned) */
+	uint32_t unused;
+} barelog_shared_ring_t;
+
+/**
+ * Clock synchronization beacon of a core, stored in shared memory.
+ * The host writes a new request, which the core answers (see barelog_sync())
+ * with the current value of its clock before copying the request into reply.
+ */
+typedef struct {
+	/** sequence number of the last request (written by the host) */
+	uint32_t request;
+	/** sequence number of the last request answered (written by the core) */
+	uint32_t reply;
+	/** epoch of the core's clock when answering (written by the core) */
+	uint32_t epoch;
+	/** timestamp of the core's clock when answering (written by the core) */
+	uint32_t timestamp;
+} barelog_sync_beacon_t;
+
+/**
+ * Counters of a core accounting for the events which did not reach the host,
+ * kept in the local memory of the core and published into shared memory
+ * (every BARELOG_STATS_PERIOD updates, at each clock synchronization and on
+ * demand, see device_mem_manager_publish_stats()). They are free-running
+ * (never reset) and only written by the core.
+ */
+typedef struct {
+	/** number of events dropped by the policies (SKIP) before reaching the
+	 * shared memory */
+	uint32_t dropped;
+	/** number of events overwritten (REPLACE) or erased (DESTROY), in the
+	 * local buffer or in the shared memory, before reaching the host */
+	uint32_t overwritten;
+	/** number of events written into the shared memory */
+	uint32_t flushed;
+	/** number of bytes written into the shared memory (padding included) */
+	uint32_t bytes;
+} barelog_core_stats_t;
+
+/**
+ * Structure used by a core to write its records into its shared ring.
+ */
+typedef struct {
+	/** control words of the ring (in shared memory) */
+	barelog_shared_ring_t *ring;
+	/** records of the ring (in shared memory) */
+	uint8_t *records;
+	/** counter of the bytes written into the ring */
+	uint32_t head;
+	/** counter of the oldest byte not overwritten */
+	uint32_t oldest;
+	/** last known counter of the bytes consumed by the host */
+	uint32_t tail;
+	/** size (in bytes) of the ring (see barelog_shared_header_t.ring_size) */
+	uint32_t size;
+	/** mask giving the position inside the ring of a counter (size - 1) */
+	uint32_t mask;
+	/** size (in bytes) of the segments of the ring in which the records are
+	 * never split : the whole ring, or a chunk if a pool is used */
+	uint32_t segment_size;
+	/** chain of chunks of the core (NULL if no pool is used) */
+	barelog_chunk_link_t *chain;
+	/** mask and shift giving the link of a counter in the chain */
+	uint32_t chain_mask;
+	uint32_t chain_shift;
+	/** pool of chunks (in shared memory) and its first chunk */
+	barelog_chunk_pool_t *pool;
+	uint8_t *chunks;
+	/** counter of the end of the segments mapped to a chunk */
+	uint32_t mapped;
+	/** last segment looked up in the chain and its chunk */
+	uint32_t segment;
+	uint8_t *chunk;
 } barelog_shared_mem_buffer_t;
 
 #endif /* __BARELOG_BUFFER__*/
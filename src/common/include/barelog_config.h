@@ -37,19 +37,45 @@
 
 /*--------------------------------*/
 /**
- * Extern configuration file to load (if any).
+ * Extern configuration file to load (if any) : the Parallella platform by
+ * default, or the simulation of the cores on Linux (see barelog_linux_sim.h).
  */
+#ifdef BARELOG_LINUX_SIM
+#include "barelog_linux_sim.h"
+#else
 #include "barelog_parallella.h"
+#endif
 /*--------------------------------*/
 
-/** Number of cores to log on */
+/** Number of cores to log on (by default, see barelog_shared_header_t) and
+ * maximum number of cores handled by the host : */
 #ifndef BARELOG_NB_CORES
 #define BARELOG_NB_CORES 16
 #endif
 
 /** Maximum size (in bytes) taken in the shared memory by barelog events : */
 #ifndef BARELOG_EVENT_SHARED_MEM_MAX
-#define BARELOG_EVENT_SHARED_MEM_MAX 1000000
+#define BARELOG_EVENT_SHARED_MEM_MAX 1048576
+#endif
+
+/** Size (in bytes) of the chunks of the pool sharing the memory of the events
+ * between the cores by default (a power of two, see host_mem_manager_set_geometry),
+ * 0 to give each core a fixed area : */
+#ifndef BARELOG_SHARED_CHUNK_SIZE
+#define BARELOG_SHARED_CHUNK_SIZE 0
+#endif
+
+/** Whether the cores can lock a word of the shared memory (see
+ * barelog_test_and_set), as needed by the pool of chunks : */
+#ifndef BARELOG_SHARED_LOCK
+#define BARELOG_SHARED_LOCK 1
+#endif
+
+/** Maximum number of attempts of a core to take the lock of the pool of
+ * chunks, before giving up with BARELOG_TIMEOUT_ERR (e.g. if the host
+ * stopped while holding it) : */
+#ifndef BARELOG_POOL_LOCK_SPIN
+#define BARELOG_POOL_LOCK_SPIN 1000000
 #endif
 
 /** Maximum string length of the platform name (deprecated) : */
@@ -64,7 +90,31 @@
 
 /** Maximum size (in bytes) of each core's local memory reserved for barelog : */
 #ifndef BARELOG_LOCAL_MEM_PER_CORE
-#define BARELOG_LOCAL_MEM_PER_CORE 1000
+#define BARELOG_LOCAL_MEM_PER_CORE 1024
+#endif
+
+/** Number of events read at once by each drain thread of the host
+ * (see barelog_host_drainer.h) : */
+#ifndef BARELOG_DRAIN_BATCH
+#define BARELOG_DRAIN_BATCH 256
+#endif
+
+/** Size (in bytes) of the blocks written into the trace segment files
+ * by the host (see barelog_host_writer.h), a multiple of 4096 : */
+#ifndef BARELOG_WRITER_BLOCK_SIZE
+#define BARELOG_WRITER_BLOCK_SIZE 1048576
+#endif
+
+/** Number of updates of the statistics of a core (events dropped, flushed...)
+ * between two publications into shared memory (see barelog_core_stats_t) : */
+#ifndef BARELOG_STATS_PERIOD
+#define BARELOG_STATS_PERIOD 32
+#endif
+
+/** Maximum number of threads scanning a trace file without index
+ * (see barelog_host_trace.h) : */
+#ifndef BARELOG_TRACE_SCAN_THREADS
+#define BARELOG_TRACE_SCAN_THREADS 8
 #endif
 
 /** (Optional) attribute used to ensure that some parts of the code are stored
@@ -74,9 +124,27 @@
 #define BARELOG_LOCAL_MEM_ATTRIBUTE
 #endif
 
-/** Memory synchronization (mutexes) between host and device (/!\ not fully tested) */
-#ifndef BARELOG_SAFE_MODE
-#define BARELOG_SAFE_MODE 0
+/** Log-level under which the BARELOG_LOG_<LEVEL> macros are kept at compile
+ * time, the other ones expanding to nothing (0 : off, 1 : critical,
+ * 2 : error, 3 : warning, 4 : debug, 5 : info, see barelog_lvl_t) */
+#ifndef BARELOG_COMPILE_LVL
+#define BARELOG_COMPILE_LVL 5
+#endif
+
+/** Stores the format identifier and the raw arguments of the events instead
+ * of formatting them on the target (the host does the formatting) */
+#ifndef BARELOG_BINARY_MODE
+#define BARELOG_BINARY_MODE 0
+#endif
+
+/** Stores the events directly into the shared memory (no local buffer, the
+ * flushing and cleaning functions do nothing). The records are managed
+ * through the read and write functions given to the logger, but the events'
+ * data is formatted in place : the shared memory must then be directly
+ * addressable by the traced core (as the external memory of the Epiphany
+ * cores), otherwise this mode must not be used. */
+#ifndef BARELOG_WRITE_THROUGH_MODE
+#define BARELOG_WRITE_THROUGH_MODE 0
 #endif
 
 /** Defines whether or not we should apply defensive strategies on code */
@@ -43,6 +43,8 @@
 
 typedef struct barelog_result_buffer_t_ barelog_result_buffer_t;
 
+#include "barelog_binary.h"
+
 /** Maximum size (in bytes) of a formatted string containing all
  * barelog event information.
  */
@@ -52,14 +54,61 @@ typedef struct barelog_result_buffer_t_ barelog_result_buffer_t;
  * Main structure of what we call an event.
  */
 typedef struct __attribute__((packed)) {
-	/** timestamp of the event */
-	uint32_t timestamp;
+	/** timestamp of the event. Cores log 32 bits timestamps, the host extends
+	 * them to 64 bits with the number of wraps of the core's clock (the
+	 * epoch, see BARELOG_RECORD_EPOCH). */
+	uint64_t timestamp;
 	/** core on which the event occured */
 	uint32_t core;
+	/** length (in bytes) of the data (set by the host when reading the events) */
+	uint16_t length;
+	/** number of the event among the ones logged by the core (wrapping, see
+	 * barelog_record_header_t) */
+	uint16_t sequence;
+	/** log-level of the event (see barelog_lvl_t), 0 if unknown */
+	uint8_t level;
+	/** flags of the record of the event (see barelog_record_header_t) */
+	uint8_t flags;
 	/** actual data contained by the event */
 	char data[BARELOG_BUF_MAX_SIZE];
 } barelog_event_t;
 
+/**
+ * Header of a record, that is to say of an event as stored inside the
+ * local and shared buffers : the header is followed by length bytes of data
+ * (the '\0' of text data included) and by some padding bytes ensuring the
+ * alignment of the next record (see BARELOG_RECORD_SIZE).
+ * The core of the record is the one owning the buffer. The sequence numbers
+ * of the events of a core are consecutive, so that the host detects the
+ * events lost (skipped, replaced or overwritten) in constant time.
+ * The layout is identified by BARELOG_RECORD_VERSION.
+ */
+typedef struct {
+	/** timestamp of the event */
+	uint32_t timestamp;
+	/** number of the event among the ones logged by the core (wrapping,
+	 * the epoch markers taking the number of the next event) */
+	uint16_t sequence;
+	/** length (in bytes) of the data (or BARELOG_RECORD_SKIP) */
+	uint8_t length;
+	/** log-level of the event (BARELOG_RECORD_LEVEL_MASK bits) and flags
+	 * of the record (BARELOG_RECORD_EPOCH) */
+	uint8_t info;
+} barelog_record_header_t;
+
+/**
+ * View over some events, rendering an event as a string only
+ * when it is accessed (see barelog_view_at()).
+ */
+typedef struct {
+	/** events of the view */
+	const barelog_event_t *events;
+	/** number of events of the view */
+	size_t length;
+	/** string of the last event accessed */
+	char line[EVENT_TO_STRING_SIZE];
+} barelog_result_view_t;
+
 /**
  * Event initializer, every field is set to 0 except for data, set to "".
  */
@@ -70,12 +119,15 @@ extern const barelog_event_t BARELOG_EVENT_INITIALIZER;
  * @param event event to convert.
  * @param buffer buffer to use for the conversion (should be
  * at least EVENT_TO_STRING_SIZE bytes long).
- * @return the return code of snprintf().
+ * @return the return code of snprintf() (BARELOG_SUCCESS in binary mode).
  */
 extern int8_t barelog_event_to_string(const barelog_event_t event, char *buffer);
 
 /**
- * Converts an events queue into a buffer of strings.
+ * Converts an events queue into a buffer of strings, allocated at once
+ * (see barelog_result_buffer_t).
+ * WARNING : it is the responsibility of the caller to free the buffer
+ * afterwards with barelog_result_free().
  * @param events events queue to convert.
  * @param n size of the events queue.
  * @param buffer result buffer.
@@ -83,4 +135,54 @@ extern int8_t barelog_event_to_string(const barelog_event_t event, char *buffer)
  */
 extern int8_t barelog_events_to_strings(const barelog_event_t *events, size_t n, barelog_result_buffer_t *buffer);
 
+/**
+ * Frees a buffer of strings filled by barelog_events_to_strings().
+ * @param buffer the result buffer to free.
+ */
+extern void barelog_result_free(barelog_result_buffer_t *buffer);
+
+/**
+ * Initializes a view over an events queue, which renders the
+ * events as strings only when they are accessed. The events queue
+ * must remain valid as long as the view is used.
+ * @param view the view to initialize.
+ * @param events events queue to view.
+ * @param n size of the events queue.
+ */
+extern void barelog_view_init(barelog_result_view_t *view, const barelog_event_t *events, size_t n);
+
+/**
+ * Renders an event of a view as a string.
+ * @param view the view of the event.
+ * @param i the index of the event in the view.
+ * @return the string of the event (valid until the next access to the
+ * view), or NULL if i is out of the view or if the conversion failed.
+ */
+extern const char *barelog_view_at(barelog_result_view_t *view, size_t i);
+
+#if BARELOG_BINARY_MODE
+/**
+ * Registers the function used to retrieve the format strings of binary
+ * events (see BARELOG_BINARY_MODE).
+ * @param resolver function returning the format string corresponding to
+ * a format identifier logged by a given core (NULL if unknown). In binary
+ * mode, the format identifier of barelog_log() is the whole address of the
+ * format string in the target's memory (stored on 32 bits or on 64 bits,
+ * depending on the address space of the target) : the resolver has to take
+ * into account the address the target's program was loaded at, if it was
+ * relocated (e.g. a PIE binary). The site identifiers of BARELOG_LOG do not
+ * depend on it (see host_sites_load()).
+ */
+extern void barelog_set_format_resolver(const char *(*resolver)(uint32_t core, uint64_t format_id));
+
+/**
+ * Registers the function used to retrieve the log sites of binary events
+ * logged through BARELOG_LOG.
+ * @param resolver function returning the site corresponding to a site
+ * identifier logged by a given core (NULL if unknown).
+ * @see host_sites_load
+ */
+extern void barelog_set_site_resolver(const barelog_site_t *(*resolver)(uint32_t core, uint16_t site_id));
+#endif // BARELOG_BINARY_MODE
+
 #endif /* __BARELOG_EVENT__ */
@@ -62,72 +62,177 @@
 /** Barelog initialization error return code */
 #define BARELOG_INIT_ERR -8
 
-/*
- * -----------------
- * - Define types. -
- * -----------------
- */
-/** barelog mutex type */
-#define barelog_shrmem_mutex_t uint8_t
-
 /*
  * ---------------------------------------------------
  * - Internal parameters (be careful if overridden). -
  * ---------------------------------------------------
  */
 
-/** Number of tries to do in order to get a mutex */
-#define BARELOG_MUTEX_TRY_MAX 5
-
-/* Computing offsets regarding the Barelog's policies :*/
-#if BARELOG_SAFE_MODE
-/** Size (in bytes) taken by the mutexes in shared memory */
-#define BARELOG_NB_MUTEX_BYTES BARELOG_NB_CORES
-/** Size (in bytes) taken by all data used by the safe mode */
-#define BARELOG_SAFE_MEM_SIZE BARELOG_NB_MUTEX_BYTES
-/** Index of the safe mode in the mem_space hierarchy */
-#define BARELOG_SAFE_MODE_I BARELOG_NB_CORES
-#else
-#define BARELOG_NB_MUTEX_BYTES 0
-#define BARELOG_SAFE_MODE_I 0
-#define BARELOG_SAFE_MEM_SIZE 0
-#endif
+/** Magic string at the beginning of the shared memory (see barelog_shared_header_t) : */
+#define BARELOG_SHARED_MAGIC "BARESHM"
 
-/* Computing offsets regarding the Barelog's policies :*/
+/** Version of the layout of the shared memory : */
+#define BARELOG_SHARED_VERSION 2
+
+/** Size (in bytes) taken by the header of the shared memory */
+#define BARELOG_SHARED_HEADER_SIZE sizeof(barelog_shared_header_t)
+
+/* Computing offsets regarding the Barelog's policies (default layout of the
+ * shared memory, the actual one being described by its header) :*/
 #if BARELOG_DEBUG_MODE
-/** Size (in bytes) taken by all data used by the debug mode */
-#define BARELOG_DEBUG_MEM_SIZE sizeof(barelog_event_t)
+/** Size (in bytes) taken by all data used by the debug mode (rounded up so
+ * that the following sections stay aligned) */
+#define BARELOG_DEBUG_MEM_SIZE \
+	((sizeof(barelog_event_t) + BARELOG_RECORD_ALIGNMENT - 1) & ~(BARELOG_RECORD_ALIGNMENT - 1))
 /** Index of the debug mode in the mem_space hierarchy */
-#define BARELOG_DEBUG_MODE_I (BARELOG_NB_CORES + BARELOG_SAFE_MODE)
+#define BARELOG_DEBUG_MODE_I BARELOG_NB_CORES
 /** Offset in the shared memory of the beginning of the debug mode section*/
-#define BARELOG_DEBUG_OFF BARELOG_SAFE_MEM_SIZE
+#define BARELOG_DEBUG_OFF BARELOG_SHARED_HEADER_SIZE
 #else
 #define BARELOG_DEBUG_MEM_SIZE 0
 #define BARELOG_DEBUG_MODE_I 0
-#define BARELOG_DEBUG_OFF 0
+#define BARELOG_DEBUG_OFF BARELOG_SHARED_HEADER_SIZE
 #endif
 
+/** Size (in bytes) taken by the control words of the shared rings */
+#define BARELOG_RING_MEM_SIZE (BARELOG_NB_CORES * sizeof(barelog_shared_ring_t))
+/** Index of the shared rings control words in the mem_space hierarchy */
+#define BARELOG_RING_I (BARELOG_NB_CORES + BARELOG_DEBUG_MODE)
+/** Offset in the shared memory of the beginning of the shared rings control words */
+#define BARELOG_RING_OFF (BARELOG_DEBUG_OFF + BARELOG_DEBUG_MEM_SIZE)
+
+/** Size (in bytes) taken by the clock synchronization beacons */
+#define BARELOG_SYNC_MEM_SIZE (BARELOG_NB_CORES * sizeof(barelog_sync_beacon_t))
+/** Index of the clock synchronization beacons in the mem_space hierarchy */
+#define BARELOG_SYNC_I (BARELOG_RING_I + 1)
+/** Offset in the shared memory of the beginning of the clock synchronization beacons */
+#define BARELOG_SYNC_OFF (BARELOG_RING_OFF + BARELOG_RING_MEM_SIZE)
+
+/** Size (in bytes) taken by the statistics of the cores */
+#define BARELOG_STATS_MEM_SIZE (BARELOG_NB_CORES * sizeof(barelog_core_stats_t))
+/** Index of the statistics of the cores in the mem_space hierarchy */
+#define BARELOG_STATS_I (BARELOG_SYNC_I + 1)
+/** Offset in the shared memory of the beginning of the statistics of the cores */
+#define BARELOG_STATS_OFF (BARELOG_SYNC_OFF + BARELOG_SYNC_MEM_SIZE)
+
 /** Defines the offset (in bytes) to use to access the events part in the shared
  * memory. It corresponds to the reserved size at the beginning of the allowed
  * shared memory used for barelog's settings such as synchronization flags.  */
-#define BARELOG_SHARED_MEM_DATA_OFFSET (BARELOG_NB_MUTEX_BYTES + BARELOG_DEBUG_MEM_SIZE)
+#define BARELOG_SHARED_MEM_DATA_OFFSET (BARELOG_STATS_OFF + BARELOG_STATS_MEM_SIZE)
 
 /** Maximum size (in bytes) taken in the shared memory by barelog data */
 #define BARELOG_SHARED_MEM_MAX (BARELOG_EVENT_SHARED_MEM_MAX + BARELOG_SHARED_MEM_DATA_OFFSET)
 
-/** Maximum size (in bytes) of the string buffer inside a barelog event : */
-#define BARELOG_BUF_MAX_SIZE (BARELOG_EVENT_MAX_SIZE - 2*sizeof(uint32_t))
+/** Size (in bytes) of the header of a record (i.e an event as stored
+ * inside the local and shared buffers) : */
+#define BARELOG_RECORD_HEADER_SIZE (2*sizeof(uint32_t))
+
+/** Alignment (in bytes) of the records inside the buffers : */
+#define BARELOG_RECORD_ALIGNMENT 4
+
+/** Size (in bytes) taken inside a buffer by a record holding length bytes of data : */
+#define BARELOG_RECORD_SIZE(length) \
+	((BARELOG_RECORD_HEADER_SIZE + (length) + BARELOG_RECORD_ALIGNMENT - 1) & ~(BARELOG_RECORD_ALIGNMENT - 1))
+
+/** Version of the layout of the records (see barelog_record_header_t) : */
+#define BARELOG_RECORD_VERSION 2
+
+/** Length of a record indicating that the following records are stored
+ * at the beginning of the buffer : */
+#define BARELOG_RECORD_SKIP 0xFF
+
+/** Bits of the info of a record holding the log-level of its event : */
+#define BARELOG_RECORD_LEVEL_MASK 0x07
+
+/** Flag set on the info of a record holding an epoch marker : the data of
+ * the record is the (32 bits) number of times the clock of the core wrapped
+ * (see barelog_event_t.timestamp) : */
+#define BARELOG_RECORD_EPOCH 0x08
+
+/** Maximum size (in bytes) of the data buffer inside a barelog event : */
+#define BARELOG_BUF_MAX_SIZE (BARELOG_EVENT_MAX_SIZE - BARELOG_RECORD_HEADER_SIZE)
+
+/* The length of the data of a record must fit in 8 bits (BARELOG_RECORD_SKIP excluded). */
+#if BARELOG_EVENT_MAX_SIZE > 8 + 254
+#error "BARELOG_EVENT_MAX_SIZE is too large (at most 262 bytes)"
+#endif
+
+/** Largest power of two lower or equal to x (for 4 <= x < 2^21) : */
+#define BARELOG_POW2_FLOOR(x) \
+	((x) >= (1 << 20) ? (1 << 20) : (x) >= (1 << 19) ? (1 << 19) : \
+	(x) >= (1 << 18) ? (1 << 18) : (x) >= (1 << 17) ? (1 << 17) : \
+	(x) >= (1 << 16) ? (1 << 16) : (x) >= (1 << 15) ? (1 << 15) : \
+	(x) >= (1 << 14) ? (1 << 14) : (x) >= (1 << 13) ? (1 << 13) : \
+	(x) >= (1 << 12) ? (1 << 12) : (x) >= (1 << 11) ? (1 << 11) : \
+	(x) >= (1 << 10) ? (1 << 10) : (x) >= (1 << 9) ? (1 << 9) : \
+	(x) >= (1 << 8) ? (1 << 8) : (x) >= (1 << 7) ? (1 << 7) : \
+	(x) >= (1 << 6) ? (1 << 6) : (x) >= (1 << 5) ? (1 << 5) : \
+	(x) >= (1 << 4) ? (1 << 4) : (x) >= (1 << 3) ? (1 << 3) : (1 << 2))
+
+/** Size (in bytes) of the records buffer stored locally in each core
+ * (rounded down to a power of two so that positions are computed by masking) : */
+#define BARELOG_LOCAL_BUFFER_SIZE BARELOG_POW2_FLOOR(BARELOG_LOCAL_MEM_PER_CORE)
+
+#if BARELOG_LOCAL_MEM_PER_CORE & (BARELOG_LOCAL_MEM_PER_CORE - 1)
+#warning "BARELOG_LOCAL_MEM_PER_CORE is not a power of two : only BARELOG_LOCAL_BUFFER_SIZE bytes of it are used"
+#endif
+
+/** Mask giving the position inside the local buffer of a head/tail counter : */
+#define BARELOG_LOCAL_BUFFER_MASK (BARELOG_LOCAL_BUFFER_SIZE - 1)
+
+/** Smallest size (in bytes) of the shared ring of a core, and of a chunk of
+ * the pool : a flush of the whole local buffer must fit into an empty one,
+ * whatever the padding before the end of the ring (or chunk) : */
+#if BARELOG_WRITE_THROUGH_MODE
+#define BARELOG_SEGMENT_MIN_SIZE BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE)
+#else
+#define BARELOG_SEGMENT_MIN_SIZE \
+	((2 * BARELOG_LOCAL_BUFFER_SIZE > BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE)) ? \
+	2 * BARELOG_LOCAL_BUFFER_SIZE : BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE))
+#endif
 
 /** Maximum number of events manageable locally per core : */
-#define BARELOG_EVENT_PER_CORE_MAX (BARELOG_LOCAL_MEM_PER_CORE/BARELOG_EVENT_MAX_SIZE)
+#define BARELOG_EVENT_PER_CORE_MAX (BARELOG_LOCAL_BUFFER_SIZE/BARELOG_RECORD_SIZE(1))
 
 /** Size (in bytes) of each shared memory area reserved per core : */
-#define BARELOG_SHARED_MEM_PER_CORE_MAX (BARELOG_EVENT_SHARED_MEM_MAX/BARELOG_NB_CORES)
+#define BARELOG_SHARED_MEM_PER_CORE_MAX \
+	((BARELOG_EVENT_SHARED_MEM_MAX/BARELOG_NB_CORES) & ~(BARELOG_RECORD_ALIGNMENT - 1))
+
+/** Size (in bytes) of the records ring inside each shared memory area
+ * (rounded down to a power of two, as the local buffer) : */
+#define BARELOG_SHARED_RING_SIZE BARELOG_POW2_FLOOR(BARELOG_SHARED_MEM_PER_CORE_MAX)
+
+/** Mask giving the position inside a shared ring of a counter : */
+#define BARELOG_SHARED_RING_MASK (BARELOG_SHARED_RING_SIZE - 1)
 
 /** Maximum number of events manageable in shared memory per core : */
-#define BARELOG_EVENT_PER_CORE_SHR_MEM_MAX (BARELOG_SHARED_MEM_PER_CORE_MAX/BARELOG_EVENT_MAX_SIZE)
+#define BARELOG_EVENT_PER_CORE_SHR_MEM_MAX (BARELOG_SHARED_RING_SIZE/BARELOG_RECORD_SIZE(1))
+
+/** Orders the accesses to the shared memory (records before control words) : */
+#define barelog_memory_barrier() __sync_synchronize()
+
+/** Atomically sets a word of the shared memory and returns its previous value,
+ * used to lock the pool of chunks (a platform header may define it, e.g. with
+ * the TESTSET instruction of the Epiphany cores) : */
+#ifndef barelog_test_and_set
+#define barelog_test_and_set(word) __sync_lock_test_and_set((word), 1)
+#endif
+
+#if !BARELOG_SHARED_LOCK && BARELOG_SHARED_CHUNK_SIZE
+#error "a pool of chunks needs a lock in shared memory (see BARELOG_SHARED_LOCK)"
+#endif
+
+/** Index of a chunk in a link of a chain left free (see barelog_chunk_link_t) : */
+#define BARELOG_CHUNK_NONE 0xFFFFFFFF
+
+/** Index of the header of the shared memory in the mem_space hierarchy */
+#define BARELOG_SHARED_HEADER_I (BARELOG_STATS_I + 1)
+
+/** Index of the pool of chunks (chains, control words and chunks) in the
+ * mem_space hierarchy */
+#define BARELOG_POOL_I (BARELOG_SHARED_HEADER_I + 1)
 
 /** Number of used barelog_mem_space_t in the host manager : */
-#define BARELOG_HOST_NB_MEM_SPACE (BARELOG_NB_CORES + BARELOG_SAFE_MODE + BARELOG_DEBUG_MODE)
+#define BARELOG_HOST_NB_MEM_SPACE (BARELOG_NB_CORES + BARELOG_DEBUG_MODE + 5)
 
 #endif /* __BARELOG_INTERNAL_H__ */
@@ -43,9 +43,11 @@ typedef enum {
 	SKIP,
 	/** When buffer full, replace with new events.*/
 	REPLACE,
-	/** When buffer full, flush it to shared memory.*/
+	/** When buffer full, flush its oldest events to shared memory, only
+	 * until the new event fits (local buffer policy only).*/
 	FLUSH,
-	/** Destroy buffer when full.*/
+	/** When buffer full, flush all of it to shared memory and empty it
+	 * (local buffer), or drop all the events not read yet (shared memory).*/
 	DESTROY,
 } barelog_policy_t;
 
@@ -0,0 +1,284 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_codec.c
+ * @brief Module implementing the compression of the blocks of the trace files.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#include "barelog_host_codec.h"
+#include "barelog_host_trace.h"
+
+#include <string.h>
+
+/* Positions (plus one) of the last data bytes hashed, 0 for none. */
+static uint32_t candidates[1 << BARELOG_CODEC_HASH_BITS];
+
+static inline uint32_t read32(const uint8_t *p) {
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static inline uint32_t hash(const uint8_t *p) {
+	return (read32(p) * 2654435761u) >> (32 - BARELOG_CODEC_HASH_BITS);
+}
+
+static inline uint8_t *varint_put(uint8_t *out, uint64_t value) {
+	while (value >= 0x80) {
+		*(out++) = (uint8_t) value | 0x80;
+		value >>= 7;
+	}
+	*(out++) = (uint8_t) value;
+	return out;
+}
+
+static inline const uint8_t *varint_get(const uint8_t *in, const uint8_t *end, uint64_t *value) {
+	uint64_t result = 0;
+	for (uint8_t shift = 0; in < end && shift < 64; shift += 7) {
+		const uint8_t byte = *(in++);
+		result |= (uint64_t) (byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			return in;
+		}
+	}
+	return NULL;
+}
+
+/* Writes the varint extending a nibble of a token (if needed). */
+static inline uint8_t *length_put(uint8_t *out, uint32_t length) {
+	return (length >= 15) ? varint_put(out, length - 15) : out;
+}
+
+/* Encodes the data of a record, located at position in the block. */
+static uint8_t *data_encode(const uint8_t *block, uint32_t position, uint32_t length, uint8_t *out) {
+	const uint32_t end = position + length;
+	uint32_t anchor = position;
+	uint32_t i = position;
+
+	while (i + BARELOG_CODEC_MIN_MATCH <= end) {
+		const uint32_t h = hash(&(block[i]));
+		const uint32_t candidate = candidates[h];
+		candidates[h] = i + 1;
+
+		if (!candidate || read32(&(block[candidate - 1])) != read32(&(block[i]))) {
+			++i;
+			continue;
+		}
+
+		uint32_t match = BARELOG_CODEC_MIN_MATCH;
+		while (i + match < end && block[candidate - 1 + match] == block[i + match]) {
+			++match;
+		}
+
+		const uint32_t literals = i - anchor;
+		const uint32_t extra = match - BARELOG_CODEC_MIN_MATCH;
+		*(out++) = ((literals < 15) ? literals : 15) << 4 | ((extra < 15) ? extra : 15);
+		out = length_put(out, literals);
+		memcpy(out, &(block[anchor]), literals);
+		out += literals;
+		out = varint_put(out, i - (candidate - 1));
+		out = length_put(out, extra);
+
+		i += match;
+		anchor = i;
+	}
+
+	if (anchor < end) {
+		const uint32_t literals = end - anchor;
+		*(out++) = ((literals < 15) ? literals : 15) << 4;
+		out = length_put(out, literals);
+		memcpy(out, &(block[anchor]), literals);
+		out += literals;
+	}
+
+	return out;
+}
+
+int32_t host_codec_encode(const uint8_t *block, uint32_t used, uint8_t *out) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (block == NULL || out == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	uint8_t *const start = out;
+	uint64_t timestamp = 0;
+	uint32_t position = 0;
+
+	memset(candidates, 0, sizeof(candidates));
+
+	while (position < used) {
+		const barelog_trace_record_t *first = (const barelog_trace_record_t *) &(block[position]);
+		const uint16_t core = first->core;
+		uint32_t count = 0;
+
+		/* Length of the run of records of the core. */
+		for (uint32_t p = position; p < used; ++count) {
+			const barelog_trace_record_t *record = (const barelog_trace_record_t *) &(block[p]);
+			if (record->core != core) {
+				break;
+			}
+			p += BARELOG_TRACE_RECORD_SIZE(record->length);
+		}
+		out = varint_put(out, core);
+		out = varint_put(out, count);
+		uint16_t sequence = first->sequence;
+		out = varint_put(out, sequence);
+
+		for (; count; --count) {
+			const barelog_trace_record_t *record = (const barelog_trace_record_t *) &(block[position]);
+			const int64_t delta = (int64_t) (record->timestamp - timestamp);
+			const int32_t gap = (int16_t) (record->sequence - sequence);
+			out = varint_put(out, ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63));
+			out = varint_put(out, ((uint64_t) (((uint32_t) gap << 1) ^ (uint32_t) (gap >> 31)) << 8)
+				| (uint8_t) (record->level | record->flags));
+			out = varint_put(out, record->length);
+			sequence = record->sequence + 1;
+			out = data_encode(block, position + sizeof(barelog_trace_record_t), record->length, out);
+			timestamp = record->timestamp;
+			position += BARELOG_TRACE_RECORD_SIZE(record->length);
+		}
+	}
+
+	return out - start;
+}
+
+/* Decodes the data of a record, to be located at position in the block. */
+static const uint8_t *data_decode(const uint8_t *in, const uint8_t *end,
+	uint8_t *block, uint32_t position, uint32_t length) {
+	const uint32_t last = position + length;
+	uint32_t i = position;
+	uint64_t value;
+
+	while (i < last) {
+		if (in >= end) {
+			return NULL;
+		}
+		const uint8_t token = *(in++);
+		uint64_t literals = token >> 4;
+		if (literals == 15) {
+			if ((in = varint_get(in, end, &value)) == NULL) {
+				return NULL;
+			}
+			literals += value;
+		}
+		if (literals > last - i || literals > (uint64_t) (end - in)) {
+			return NULL;
+		}
+		memcpy(&(block[i]), in, literals);
+		in += literals;
+		i += literals;
+		if (i == last) {
+			break;
+		}
+
+		uint64_t distance;
+		uint64_t match = (token & 0xf) + BARELOG_CODEC_MIN_MATCH;
+		if ((in = varint_get(in, end, &distance)) == NULL) {
+			return NULL;
+		}
+		if ((token & 0xf) == 15) {
+			if ((in = varint_get(in, end, &value)) == NULL) {
+				return NULL;
+			}
+			match += value;
+		}
+		if (!distance || distance > i || match > last - i) {
+			return NULL;
+		}
+		if (distance >= match) {
+			memcpy(&(block[i]), &(block[i - distance]), match);
+			i += match;
+		} else {
+			/* Byte by byte : the match overlaps the bytes it produces. */
+			for (const uint8_t *from = &(block[i - distance]); match; --match) {
+				block[i++] = *(from++);
+			}
+		}
+	}
+
+	return in;
+}
+
+int32_t host_codec_decode(const uint8_t *in, uint32_t size, uint8_t *block, uint32_t capacity) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (in == NULL || block == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	const uint8_t *const end = in + size;
+	uint64_t timestamp = 0;
+	uint32_t position = 0;
+
+	while (in < end) {
+		uint64_t core, count, first;
+		if ((in = varint_get(in, end, &core)) == NULL
+			|| (in = varint_get(in, end, &count)) == NULL
+			|| (in = varint_get(in, end, &first)) == NULL
+			|| core > UINT16_MAX) {
+			return BARELOG_EVENT_CONVERSION_ERR;
+		}
+		uint16_t sequence = first;
+
+		for (; count; --count) {
+			uint64_t delta, info, length;
+			if ((in = varint_get(in, end, &delta)) == NULL
+				|| (in = varint_get(in, end, &info)) == NULL
+				|| (in = varint_get(in, end, &length)) == NULL
+				|| length > BARELOG_BUF_MAX_SIZE
+				|| BARELOG_TRACE_RECORD_SIZE(length) > capacity - position) {
+				return BARELOG_EVENT_CONVERSION_ERR;
+			}
+
+			barelog_trace_record_t record;
+			timestamp += (delta >> 1) ^ -(delta & 1);
+			record.timestamp = timestamp;
+			record.core = core;
+			record.length = length;
+			const uint64_t gap = info >> 8;
+			record.sequence = sequence + (uint16_t) ((gap >> 1) ^ -(gap & 1));
+			record.level = info & BARELOG_RECORD_LEVEL_MASK;
+			record.flags = info & 0xff & ~BARELOG_RECORD_LEVEL_MASK;
+			sequence = record.sequence + 1;
+			memcpy(&(block[position]), &record, sizeof(barelog_trace_record_t));
+			memset(&(block[position + sizeof(barelog_trace_record_t) + length]), 0,
+				BARELOG_TRACE_RECORD_SIZE(length) - sizeof(barelog_trace_record_t) - length);
+
+			in = data_decode(in, end, block, position + sizeof(barelog_trace_record_t), length);
+			if (in == NULL) {
+				return BARELOG_EVENT_CONVERSION_ERR;
+			}
+			position += BARELOG_TRACE_RECORD_SIZE(length);
+		}
+	}
+
+	return position;
+}
@@ -0,0 +1,254 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#define _GNU_SOURCE // pthread_attr_setaffinity_np()
+
+#include "barelog_host_drainer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "barelog_host_mem_manager.h"
+
+/* Drain thread, along with its own staging buffer and statistics. */
+typedef struct {
+	pthread_t id;
+	uint32_t index;
+	int8_t ret;
+	uint64_t events;
+	uint64_t bytes;
+	uint64_t overwritten;
+	uint64_t lost;
+	uint64_t sweeps;
+	barelog_event_t staging[BARELOG_DRAIN_BATCH];
+} drain_thread_t;
+
+static struct {
+	drain_thread_t *threads;
+	uint32_t nb_threads;
+	/* Reading position of each core (a core is read by a single thread). */
+	barelog_host_cursor_t cursors[BARELOG_NB_CORES];
+	/* Number of cores drained (see host_mem_manager_nb_cores). */
+	uint32_t nb_cores;
+	void (*consume)(const barelog_drain_batch_t *batch, void *arg);
+	void *arg;
+	uint32_t period;
+	uint8_t running;
+	struct timespec start;
+	struct timespec end;
+	/* Statistics of the threads of the last drain, once stopped. */
+	barelog_drain_stats_t last;
+} drainer;
+
+static inline void stat_add(uint64_t *stat, uint64_t value) {
+	__atomic_store_n(stat, __atomic_load_n(stat, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static double elapsed(const struct timespec *from, const struct timespec *to) {
+	return (double) (to->tv_sec - from->tv_sec) + (double) (to->tv_nsec - from->tv_nsec) * 1e-9;
+}
+
+/* Reads all the events published by a core, one staging batch at a time. */
+static int32_t drain_core(drain_thread_t *thread, uint32_t core) {
+	barelog_host_cursor_t *cursor = &(drainer.cursors[core]);
+	barelog_drain_batch_t batch = { .core = core, .thread = thread->index, .events = thread->staging };
+	int32_t n = 0;
+	int32_t total = 0;
+
+	do {
+		const uint32_t position = cursor->position;
+		const uint32_t overwritten = cursor->overwritten;
+		const uint32_t lost = cursor->lost;
+		n = host_mem_manager_read_new(core, cursor, thread->staging, BARELOG_DRAIN_BATCH);
+		if (n < 0) {
+			return n;
+		}
+		if (n) {
+			batch.length = n;
+			drainer.consume(&batch, drainer.arg);
+		}
+		stat_add(&(thread->events), n);
+		stat_add(&(thread->bytes), (cursor->position - position) - (cursor->overwritten - overwritten));
+		stat_add(&(thread->overwritten), cursor->overwritten - overwritten);
+		stat_add(&(thread->lost), cursor->lost - lost);
+		total += n;
+	} while (n == BARELOG_DRAIN_BATCH);
+
+	return total;
+}
+
+static void *drain_thread(void *param) {
+	drain_thread_t *thread = (drain_thread_t *) param;
+	uint8_t last = 0;
+
+	/* Once stopped, a last sweep drains what the cores published meanwhile. */
+	do {
+		int32_t drained = 0;
+		last = !__atomic_load_n(&(drainer.running), __ATOMIC_ACQUIRE);
+		for (uint32_t core = thread->index; core < drainer.nb_cores; core += drainer.nb_threads) {
+			const int32_t n = drain_core(thread, core);
+			if (n < 0) {
+				thread->ret = n;
+				return NULL;
+			}
+			drained += n;
+		}
+		stat_add(&(thread->sweeps), 1);
+		if (!drained && !last) {
+			usleep(drainer.period);
+		}
+	} while (!last);
+
+	return NULL;
+}
+
+static int8_t drainer_join(uint32_t nb_threads) {
+	int8_t ret = BARELOG_SUCCESS;
+
+	__atomic_store_n(&(drainer.running), 0, __ATOMIC_RELEASE);
+	memset(&(drainer.last), 0, sizeof(barelog_drain_stats_t));
+	for (uint32_t i = 0; i < nb_threads; ++i) {
+		pthread_join(drainer.threads[i].id, NULL);
+		if (ret == BARELOG_SUCCESS) {
+			ret = drainer.threads[i].ret;
+		}
+		drainer.last.events += drainer.threads[i].events;
+		drainer.last.bytes += drainer.threads[i].bytes;
+		drainer.last.overwritten += drainer.threads[i].overwritten;
+		drainer.last.lost += drainer.threads[i].lost;
+		drainer.last.sweeps += drainer.threads[i].sweeps;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &(drainer.end));
+
+	free(drainer.threads);
+	drainer.threads = NULL;
+	drainer.nb_threads = 0;
+
+	return ret;
+}
+
+int8_t host_drainer_start(uint32_t nb_threads, const int32_t *cpus,
+		void (*consume)(const barelog_drain_batch_t *batch, void *arg), void *arg,
+		uint32_t period) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (consume == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+
+	if (nb_threads == 0 || nb_threads > host_mem_manager_nb_cores()) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	if (drainer.threads != NULL) {
+		return BARELOG_INIT_ERR;
+	}
+
+	drainer.nb_cores = host_mem_manager_nb_cores();
+	for (uint32_t core = 0; core < drainer.nb_cores; ++core) {
+		if (host_mem_manager_cursor_init(core, &(drainer.cursors[core])) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_READ_ERR;
+		}
+	}
+
+	drainer.threads = calloc(nb_threads, sizeof(drain_thread_t));
+	if (drainer.threads == NULL) {
+		return BARELOG_ERR;
+	}
+	drainer.nb_threads = nb_threads;
+	drainer.consume = consume;
+	drainer.arg = arg;
+	drainer.period = period;
+	drainer.running = 1;
+	clock_gettime(CLOCK_MONOTONIC, &(drainer.start));
+
+	for (uint32_t i = 0; i < nb_threads; ++i) {
+		pthread_attr_t attr;
+		int err = pthread_attr_init(&attr);
+		drainer.threads[i].index = i;
+		if (!err && cpus != NULL && cpus[i] >= 0) {
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpus[i], &set);
+			err = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set);
+		}
+		if (!err) {
+			err = pthread_create(&(drainer.threads[i].id), &attr, drain_thread, &(drainer.threads[i]));
+		}
+		pthread_attr_destroy(&attr);
+		if (err) {
+			drainer_join(i);
+			return BARELOG_INIT_ERR;
+		}
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_drainer_stop(void) {
+
+	if (drainer.threads == NULL) {
+		return BARELOG_INIT_ERR;
+	}
+
+	return drainer_join(drainer.nb_threads);
+}
+
+int8_t host_drainer_stats(barelog_drain_stats_t *stats) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (stats == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	struct timespec now;
+
+	if (drainer.threads == NULL) {
+		*stats = drainer.last;
+		now = drainer.end;
+	} else {
+		memset(stats, 0, sizeof(barelog_drain_stats_t));
+		for (uint32_t i = 0; i < drainer.nb_threads; ++i) {
+			stats->events += __atomic_load_n(&(drainer.threads[i].events), __ATOMIC_RELAXED);
+			stats->bytes += __atomic_load_n(&(drainer.threads[i].bytes), __ATOMIC_RELAXED);
+			stats->overwritten += __atomic_load_n(&(drainer.threads[i].overwritten), __ATOMIC_RELAXED);
+			stats->lost += __atomic_load_n(&(drainer.threads[i].lost), __ATOMIC_RELAXED);
+			stats->sweeps += __atomic_load_n(&(drainer.threads[i].sweeps), __ATOMIC_RELAXED);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	}
+
+	stats->elapsed = elapsed(&(drainer.start), &now);
+	if (stats->elapsed > 0) {
+		stats->events_rate = stats->events / stats->elapsed;
+		stats->bytes_rate = stats->bytes / stats->elapsed;
+	}
+
+	return BARELOG_SUCCESS;
+}
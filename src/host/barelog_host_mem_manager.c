@@ -26,6 +26,8 @@
 
 #include "barelog_internal.h"
 #include "barelog_host_mem_manager.h"
+#include "barelog_host_sites.h"
+#include "barelog_host_sync.h"
 #include "barelog_mem_space.h"
 #include "barelog_buffer.h"
 
@@ -39,43 +41,286 @@
  */
 #define BARELOG_MEM_SPACE_DATA_SIZE 512
 
+/* Number of records copied between two checks of the records
+ * overwritten by a core (and initial size of the buffers of
+ * host_mem_manager_read_mem_space).
+ */
+#define BARELOG_HOST_READ_BATCH 64
+
 static barelog_host_mem_manager_t manager;
 
-#if BARELOG_SAFE_MODE
-#define barelog_get_mutex(core, mutex) do { \
-	if (manager.read(mem_space[BARELOG_NB_CORES].base + (core), 1, &(mutex)) != BARELOG_SUCCESS) { \
-		return BARELOG_SHRMEM_READ_ERR; \
-	} \
-} while(0)
-
-#define barelog_set_mutex(core, value) do { \
-	uint8_t set_mutex_tmp = (value); \
-	if (manager.write(mem_space[BARELOG_NB_CORES].base + (core), 1, &set_mutex_tmp) != BARELOG_SUCCESS) { \
-		return BARELOG_SHRMEM_WRITE_ERR; \
-	} \
-} while(0)
-
-#define barelog_try_mutex(core) do { \
-uint8_t __mutex = 1; \
-uint32_t __timeout = BARELOG_MUTEX_TRY_MAX; \
-while (__mutex) { \
-	--__timeout; \
-	barelog_get_mutex((core), __mutex); \
-	if (__timeout <= 0) { \
-		return BARELOG_TIMEOUT_ERR; \
-	} \
-} \
-} while(0)
-#else
-
-#define barelog_get_mutex(core, mutex)
-#define barelog_set_mutex(core, value)
-#define barelog_try_mutex(core)
-
-#endif // BARELOG_SAFE_MODE
+/* Initializes the mem_space of index i on the given area of the shared memory. */
+static int8_t area_init(uint32_t i, void *phy_base, size_t length,
+	const barelog_mem_space_t *platform) {
+	manager.mem_space[i].phy_base = phy_base;
+	manager.mem_space[i].length = length;
+	manager.mem_space[i].alignment = platform->alignment;
+	manager.mem_space[i].word_size = platform->word_size;
+	manager.mem_space[i].data = calloc(1, BARELOG_MEM_SPACE_DATA_SIZE);
+	manager.mem_space[i].base = manager.init(manager.mem_space[i].phy_base,
+		manager.mem_space[i].length, manager.mem_space[i].data);
+	if (manager.mem_space[i].base == NULL) {
+		free(manager.mem_space[i].data);
+		manager.mem_space[i].data = NULL;
+		return BARELOG_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+/* Computes the layout of the shared memory for the given geometry. */
+static void header_layout(barelog_shared_header_t *header, uint32_t nb_cores,
+	uint32_t ring_size, uint32_t core_size, uint32_t chunk_size) {
+	memset(header, 0, sizeof(barelog_shared_header_t));
+	header->version = BARELOG_SHARED_VERSION;
+	header->record_version = BARELOG_RECORD_VERSION;
+	header->nb_cores = nb_cores;
+	header->event_max_size = BARELOG_EVENT_MAX_SIZE;
+	header->ring_size = ring_size;
+	header->core_size = core_size;
+	header->debug_offset = BARELOG_SHARED_HEADER_SIZE;
+	header->debug_size = BARELOG_DEBUG_MEM_SIZE;
+	header->ring_offset = header->debug_offset + header->debug_size;
+	header->sync_offset = header->ring_offset + nb_cores * sizeof(barelog_shared_ring_t);
+	header->stats_offset = header->sync_offset + nb_cores * sizeof(barelog_sync_beacon_t);
+	header->data_offset = header->stats_offset + nb_cores * sizeof(barelog_core_stats_t);
+	header->size = header->data_offset + nb_cores * core_size;
+	if (!chunk_size) {
+		return;
+	}
+
+	/* The chunks, the chains of the cores and the stack of the free chunks
+	 * take the memory of the fixed areas they replace. */
+	const uint64_t budget = (uint64_t) nb_cores * core_size;
+	uint32_t nb_chunks = budget / chunk_size;
+	uint32_t chain_length = 1;
+	uint64_t control = 0;
+	for (; nb_chunks; --nb_chunks) {
+		/* A single core can take half of the pool at least. */
+		for (chain_length = 1; chain_length * 2 <= nb_chunks; chain_length *= 2) {
+		}
+		control = ((uint64_t) nb_cores * chain_length * sizeof(barelog_chunk_link_t)
+			+ sizeof(barelog_chunk_pool_t) + nb_chunks * sizeof(uint32_t)
+			+ BARELOG_RECORD_ALIGNMENT - 1) & ~(BARELOG_RECORD_ALIGNMENT - 1);
+		if (control + (uint64_t) nb_chunks * chunk_size <= budget) {
+			break;
+		}
+	}
+	header->ring_size = chain_length * chunk_size;
+	header->core_size = 0;
+	header->chunk_size = chunk_size;
+	header->nb_chunks = nb_chunks;
+	header->chain_offset = header->data_offset;
+	header->pool_offset = header->chain_offset + nb_cores * chain_length * sizeof(barelog_chunk_link_t);
+	header->data_offset = header->chain_offset + control;
+	header->size = header->data_offset + nb_chunks * chunk_size;
+}
+
+/* Checks that a layout found in the shared memory can be used by this host. */
+static int8_t header_check(const barelog_shared_header_t *header, size_t length) {
+	const uint64_t nb_cores = header->nb_cores;
+
+	if (header->version != BARELOG_SHARED_VERSION
+		|| header->record_version != BARELOG_RECORD_VERSION
+		|| !nb_cores || nb_cores > BARELOG_NB_CORES
+		|| header->event_max_size > BARELOG_EVENT_MAX_SIZE
+		|| header->ring_size & (header->ring_size - 1)
+		|| header->ring_size < BARELOG_SEGMENT_MIN_SIZE
+		|| (!header->chunk_size && header->core_size < header->ring_size)
+		|| header->debug_size < BARELOG_DEBUG_MEM_SIZE
+		|| (header->ring_offset | header->sync_offset | header->stats_offset
+			| header->data_offset | header->core_size) & (BARELOG_RECORD_ALIGNMENT - 1)
+		|| header->size > length
+		|| (uint64_t) header->debug_offset + header->debug_size > header->size
+		|| header->ring_offset + nb_cores * sizeof(barelog_shared_ring_t) > header->size
+		|| header->sync_offset + nb_cores * sizeof(barelog_sync_beacon_t) > header->size
+		|| header->stats_offset + nb_cores * sizeof(barelog_core_stats_t) > header->size
+		|| header->data_offset + nb_cores * header->core_size > header->size) {
+		return BARELOG_INIT_ERR;
+	}
+
+	/* Pool of chunks : */
+	const uint64_t chunk_size = header->chunk_size;
+	if (chunk_size && (!BARELOG_SHARED_LOCK || chunk_size & (chunk_size - 1)
+		|| chunk_size < BARELOG_SEGMENT_MIN_SIZE
+		|| chunk_size > header->ring_size || !header->nb_chunks
+		|| (header->chain_offset | header->pool_offset) & (BARELOG_RECORD_ALIGNMENT - 1)
+		|| header->chain_offset + nb_cores * (header->ring_size / chunk_size)
+			* sizeof(barelog_chunk_link_t) > header->size
+		|| header->pool_offset + sizeof(barelog_chunk_pool_t)
+			+ header->nb_chunks * sizeof(uint32_t) > header->size
+		|| header->chain_offset > header->pool_offset
+		|| header->pool_offset > header->data_offset
+		|| header->data_offset + header->nb_chunks * chunk_size > header->size)) {
+		return BARELOG_INIT_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+/* Sets a word of the shared memory directly, the shared memory being
+ * addressable by the host (see host_mem_manager_set_test_and_set). */
+static int8_t shared_test_and_set(void *address, uint32_t *previous) {
+	*previous = barelog_test_and_set((uint32_t *) address);
+
+	return BARELOG_SUCCESS;
+}
+
+/* Takes the lock of the pool of chunks (shared with the cores). */
+static inline int8_t pool_lock(barelog_chunk_pool_t **pool) {
+	int8_t (*test_and_set)(void *, uint32_t *) = (manager.test_and_set) ?
+		manager.test_and_set : shared_test_and_set;
+	uint32_t locked = 1;
+
+	*pool = (barelog_chunk_pool_t *) ((uint8_t *) manager.mem_space[BARELOG_POOL_I].base
+		+ manager.header.pool_offset - manager.header.chain_offset);
+	while (locked) {
+		if (test_and_set(&((*pool)->lock), &locked) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_WRITE_ERR;
+		}
+	}
+	barelog_memory_barrier();
+
+	return BARELOG_SUCCESS;
+}
+
+/* Releases the lock of the pool of chunks, returning ret. */
+static inline int8_t pool_unlock(barelog_chunk_pool_t *pool, int8_t ret) {
+	const uint32_t unlocked = 0;
+
+	barelog_memory_barrier();
+	if (manager.write(&(pool->lock), sizeof(uint32_t), &unlocked) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+
+	return ret;
+}
+
+/* Returns the link of the chain of a core given to one of its segments. */
+static inline barelog_chunk_link_t *pool_link(uint32_t core, uint32_t segment) {
+	const uint32_t chain_length = manager.header.ring_size / manager.header.chunk_size;
+
+	return (barelog_chunk_link_t *) manager.mem_space[BARELOG_POOL_I].base
+		+ core * chain_length + (segment / manager.header.chunk_size) % chain_length;
+}
+
+/* Returns the address of the chunk holding a segment of the ring of a core,
+ * NULL if the chunk was given back to the pool (the segment being consumed or
+ * overwritten). */
+static const uint8_t *pool_chunk(uint32_t core, uint32_t segment) {
+	barelog_chunk_link_t link;
+
+	if (manager.read(pool_link(core, segment), sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS
+		|| link.segment != segment || link.chunk >= manager.header.nb_chunks) {
+		return NULL;
+	}
+
+	return (const uint8_t *) manager.mem_space[BARELOG_POOL_I].base
+		+ manager.header.data_offset - manager.header.chain_offset
+		+ (size_t) link.chunk * manager.header.chunk_size;
+}
+
+/* Gives back to the pool the chunks of the segments of the ring of a core
+ * consumed between the from and end counters, unless the core already did. */
+static int8_t pool_release(uint32_t core, uint32_t from, uint32_t end) {
+	const uint32_t chunk_size = manager.header.chunk_size;
+	barelog_chunk_link_t link;
+	uint32_t count = 0;
+	int8_t ret = BARELOG_SUCCESS;
+
+	uint32_t segment = from & ~(chunk_size - 1);
+	if (end - segment > manager.header.ring_size) {
+		segment = (end - manager.header.ring_size) & ~(chunk_size - 1);
+	}
+	if (end - segment < chunk_size) {
+		return BARELOG_SUCCESS;
+	}
+
+	barelog_chunk_pool_t *pool;
+	if (pool_lock(&pool) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	uint32_t *stack = (uint32_t *) (pool + 1);
+	if (manager.read(&(pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		return pool_unlock(pool, BARELOG_SHRMEM_READ_ERR);
+	}
+	for (; end - segment >= chunk_size; segment += chunk_size) {
+		barelog_chunk_link_t *slot = pool_link(core, segment);
+		if (manager.read(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_READ_ERR;
+			break;
+		}
+		if (link.segment != segment || link.chunk == BARELOG_CHUNK_NONE) {
+			continue;
+		}
+		if (manager.write(&(stack[count++]), sizeof(uint32_t), &(link.chunk)) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_WRITE_ERR;
+			break;
+		}
+		link.chunk = BARELOG_CHUNK_NONE;
+		if (manager.write(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_WRITE_ERR;
+			break;
+		}
+	}
+	if (manager.write(&(pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_WRITE_ERR;
+	}
+
+	return pool_unlock(pool, ret);
+}
+
+int8_t host_mem_manager_set_geometry(uint32_t nb_cores, uint32_t ring_size, uint32_t chunk_size) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (manager.initialized) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	if ((nb_cores || ring_size) && (!nb_cores || nb_cores > BARELOG_NB_CORES
+		|| ring_size & (ring_size - 1) || ring_size < BARELOG_SEGMENT_MIN_SIZE
+		|| ring_size > (UINT32_C(1) << 30) || chunk_size & (chunk_size - 1)
+		|| (chunk_size && (!BARELOG_SHARED_LOCK || chunk_size < BARELOG_SEGMENT_MIN_SIZE))
+		|| chunk_size > ring_size)) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	manager.geometry_cores = nb_cores;
+	manager.geometry_ring = ring_size;
+	manager.geometry_chunk = chunk_size;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_mem_manager_set_test_and_set(int8_t (*test_and_set)(void *address, uint32_t *previous)) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (manager.initialized) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	manager.test_and_set = test_and_set;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_mem_manager_keep_layout(uint8_t keep) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (manager.initialized) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	manager.keep_layout = (keep != 0);
+
+	return BARELOG_SUCCESS;
+}
 
 // Retourne le nombre de zones correctement allouees.
-int8_t host_mem_manager_init(const barelog_platform_t platform,
+int32_t host_mem_manager_init(const barelog_platform_t platform,
 		void * (*init)(void *address, size_t size, void *data),
 		int8_t (*read)(const void *address, size_t size, void *buffer),
 		int8_t (*write)(void *address, size_t size, const void *buffer),
@@ -85,10 +330,6 @@ int8_t host_mem_manager_init(const barelog_platform_t platform,
 	if (manager.initialized || !init || !finalize || !platform.mem_space.phy_base) {
 		return BARELOG_UNINITIALIZED_PARAM_ERR;
 	}
-
-	if (platform.mem_space.length <= BARELOG_SHARED_MEM_MAX) {
-		return BARELOG_INIT_ERR;
-	}
 #endif
 
 	manager.init = init;
@@ -97,63 +338,115 @@ int8_t host_mem_manager_init(const barelog_platform_t platform,
 	manager.finalize = finalize;
 	// TODO : alignment concerns...
 
-	/* Barelog's configuration areas : */
-	// Memory synchronization (mutexes between host and device) :
-#if BARELOG_SAFE_MODE
-	mem_space[BARELOG_SAFE_MODE_I].phy_base = platform.mem_space.phy_base;
-	mem_space[BARELOG_SAFE_MODE_I].length = BARELOG_SAFE_MEM_SIZE;
-	mem_space[BARELOG_SAFE_MODE_I].alignment = platform.mem_space.alignment;
-	mem_space[BARELOG_SAFE_MODE_I].word_size = platform.mem_space.word_size;
-	mem_space[BARELOG_SAFE_MODE_I].data = calloc(1, BARELOG_MEM_SPACE_DATA_SIZE);
-	mem_space[BARELOG_SAFE_MODE_I].base = manager.init(mem_space[BARELOG_SAFE_MODE_I].phy_base,
-							mem_space[BARELOG_SAFE_MODE_I].length,
-							mem_space[BARELOG_SAFE_MODE_I].data);
-	if (mem_space[BARELOG_SAFE_MODE_I].base == NULL) {
-		free(mem_space[BARELOG_SAFE_MODE_I].data);
+	/* Header of the shared memory : a valid header is only kept if asked
+	 * (e.g. written by the loader of the board). */
+	barelog_shared_header_t *header = &(manager.header);
+	void *shared = platform.mem_space.phy_base;
+	if (area_init(BARELOG_SHARED_HEADER_I, shared, BARELOG_SHARED_HEADER_SIZE,
+		&(platform.mem_space)) != BARELOG_SUCCESS) {
 		return BARELOG_ERR;
 	}
-	memset(mem_space[BARELOG_SAFE_MODE_I].base, 0, BARELOG_NB_MUTEX_BYTES);
-#endif // BARELOG_SAFE_MODE
+	if (manager.read(manager.mem_space[BARELOG_SHARED_HEADER_I].base,
+		BARELOG_SHARED_HEADER_SIZE, header) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	const uint8_t found = manager.keep_layout
+		&& !memcmp(header->magic, BARELOG_SHARED_MAGIC, sizeof(BARELOG_SHARED_MAGIC));
+	if (!found) {
+		if (manager.geometry_cores) {
+			header_layout(header, manager.geometry_cores, manager.geometry_ring,
+				manager.geometry_ring, manager.geometry_chunk);
+		} else {
+			header_layout(header, BARELOG_NB_CORES, BARELOG_SHARED_RING_SIZE,
+				BARELOG_SHARED_MEM_PER_CORE_MAX, BARELOG_SHARED_CHUNK_SIZE);
+		}
+	}
+	if (header_check(header, platform.mem_space.length) != BARELOG_SUCCESS) {
+		return BARELOG_INIT_ERR;
+	}
+	const uint32_t nb_cores = header->nb_cores;
 
+	/* Barelog's configuration areas : */
 #if BARELOG_DEBUG_MODE
-	manager.mem_space[BARELOG_DEBUG_MODE_I].phy_base = platform.mem_space.phy_base + BARELOG_DEBUG_OFF;
-	manager.mem_space[BARELOG_DEBUG_MODE_I].length = BARELOG_DEBUG_MEM_SIZE;
-	manager.mem_space[BARELOG_DEBUG_MODE_I].alignment = platform.mem_space.alignment;
-	manager.mem_space[BARELOG_DEBUG_MODE_I].word_size = platform.mem_space.word_size;
-	manager.mem_space[BARELOG_DEBUG_MODE_I].data = calloc(1, BARELOG_MEM_SPACE_DATA_SIZE);
-	manager.mem_space[BARELOG_DEBUG_MODE_I].base = manager.init(manager.mem_space[BARELOG_DEBUG_MODE_I].phy_base,
-		manager.mem_space[BARELOG_DEBUG_MODE_I].length,
-		manager.mem_space[BARELOG_DEBUG_MODE_I].data);
-	if (manager.mem_space[BARELOG_DEBUG_MODE_I].base == NULL) {
-		free(manager.mem_space[BARELOG_DEBUG_MODE_I].data);
+	if (area_init(BARELOG_DEBUG_MODE_I, shared + header->debug_offset,
+		BARELOG_DEBUG_MEM_SIZE, &(platform.mem_space)) != BARELOG_SUCCESS) {
 		return BARELOG_ERR;
 	}
 	memset(manager.mem_space[BARELOG_DEBUG_MODE_I].base, 0, BARELOG_DEBUG_MEM_SIZE);
 #endif // BARELOG_DEBUG_MODE
+
+	// Control words of the shared rings :
+	if (area_init(BARELOG_RING_I, shared + header->ring_offset,
+		nb_cores * sizeof(barelog_shared_ring_t), &(platform.mem_space)) != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+	memset(manager.mem_space[BARELOG_RING_I].base, 0, nb_cores * sizeof(barelog_shared_ring_t));
+
+	// Clock synchronization beacons :
+	if (area_init(BARELOG_SYNC_I, shared + header->sync_offset,
+		nb_cores * sizeof(barelog_sync_beacon_t), &(platform.mem_space)) != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+	memset(manager.mem_space[BARELOG_SYNC_I].base, 0, nb_cores * sizeof(barelog_sync_beacon_t));
+
+	// Statistics of the cores :
+	if (area_init(BARELOG_STATS_I, shared + header->stats_offset,
+		nb_cores * sizeof(barelog_core_stats_t), &(platform.mem_space)) != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+	memset(manager.mem_space[BARELOG_STATS_I].base, 0, nb_cores * sizeof(barelog_core_stats_t));
 	/* End of Barelog's configuration areas. */
 
-	/* Barelog's data areas, used to store events in shared memory : */
-	void *base = platform.mem_space.phy_base + BARELOG_SHARED_MEM_DATA_OFFSET;
-	for (uint32_t i = 0; i < BARELOG_NB_CORES; ++i) {
-		manager.mem_space[i].phy_base = base
-				+ i * BARELOG_SHARED_MEM_PER_CORE_MAX;
-		manager.mem_space[i].length = BARELOG_SHARED_MEM_PER_CORE_MAX;
-		manager.mem_space[i].alignment = platform.mem_space.alignment;
-		manager.mem_space[i].word_size = platform.mem_space.word_size;
-		manager.mem_space[i].data = calloc(1, BARELOG_MEM_SPACE_DATA_SIZE);
-		manager.mem_space[i].base = manager.init(manager.mem_space[i].phy_base,
-			manager.mem_space[i].length, manager.mem_space[i].data);
-		if (manager.mem_space[i].base == NULL) {
-			free(manager.mem_space[i].data);
+	/* Barelog's data areas, used to store events in shared memory : either
+	 * a pool of chunks (all free, see barelog_chunk_link_t), */
+	if (header->chunk_size) {
+		if (area_init(BARELOG_POOL_I, shared + header->chain_offset,
+			header->size - header->chain_offset, &(platform.mem_space)) != BARELOG_SUCCESS) {
+			return BARELOG_ERR;
+		}
+		uint8_t *pool = manager.mem_space[BARELOG_POOL_I].base;
+		memset(pool, 0, manager.mem_space[BARELOG_POOL_I].length);
+		barelog_chunk_link_t *chain = (barelog_chunk_link_t *) pool;
+		for (uint32_t i = 0; i < nb_cores * (header->ring_size / header->chunk_size); ++i) {
+			chain[i].chunk = BARELOG_CHUNK_NONE;
+		}
+		barelog_chunk_pool_t *control = (barelog_chunk_pool_t *) (pool
+			+ header->pool_offset - header->chain_offset);
+		uint32_t *stack = (uint32_t *) (control + 1);
+		for (uint32_t i = 0; i < header->nb_chunks; ++i) {
+			stack[i] = header->nb_chunks - 1 - i;
+		}
+		control->count = header->nb_chunks;
+	}
+	/* or a fixed area per core. */
+	void *base = shared + header->data_offset;
+	for (uint32_t i = 0; i < nb_cores && !header->chunk_size; ++i) {
+		if (area_init(i, base + i * header->core_size, header->core_size,
+			&(platform.mem_space)) != BARELOG_SUCCESS) {
 			return i - 1;
 		}
 		memset(manager.mem_space[i].base, 0, manager.mem_space[i].length);
 	}
 	/* End of Barelog's data areas. */
 
+	/* The magic is written last : the cores only use a complete layout. */
+	if (!found) {
+		if (manager.write(manager.mem_space[BARELOG_SHARED_HEADER_I].base,
+			BARELOG_SHARED_HEADER_SIZE, header) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_WRITE_ERR;
+		}
+		barelog_memory_barrier();
+		if (manager.write(manager.mem_space[BARELOG_SHARED_HEADER_I].base, sizeof(BARELOG_SHARED_MAGIC),
+			BARELOG_SHARED_MAGIC) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_WRITE_ERR;
+		}
+		memcpy(header->magic, BARELOG_SHARED_MAGIC, sizeof(BARELOG_SHARED_MAGIC));
+	}
+
+	memset(manager.cursors, 0, sizeof(manager.cursors));
 	manager.initialized = 1;
 
-	return BARELOG_NB_CORES;
+	return nb_cores;
 }
 
 int8_t host_mem_manager_finalize(void) {
@@ -165,6 +458,10 @@ int8_t host_mem_manager_finalize(void) {
 #endif
 
 	for (uint32_t i = 0; i < BARELOG_HOST_NB_MEM_SPACE; ++i) {
+		/* Only the cores described by the header have a mem_space. */
+		if (manager.mem_space[i].base == NULL) {
+			continue;
+		}
 		if (manager.finalize(manager.mem_space[i].data) != BARELOG_SUCCESS) {
 			/* FIXME : it could not always be the "data" field that corresponds to
 			 * the data to deallocate. A safest way to proceed could be
@@ -175,17 +472,24 @@ int8_t host_mem_manager_finalize(void) {
 			return i;
 		}
 		free(manager.mem_space[i].data);
+		memset(&manager.mem_space[i], 0, sizeof(barelog_mem_space_t));
 	}
 
+	host_sites_unload();
+
 	manager.initialized = 0;
 
-	return BARELOG_NB_CORES;
+	return manager.header.nb_cores;
+}
+
+uint32_t host_mem_manager_nb_cores(void) {
+	return (manager.initialized) ? manager.header.nb_cores : 0;
 }
 
 int32_t host_mem_manager_read_mem_space(uint32_t core, barelog_event_t **events) {
 
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
-	if (core >= BARELOG_NB_CORES || core < 0) {
+	if (core >= manager.header.nb_cores) {
 		return BARELOG_INCONSISTENT_PARAM_ERR;
 	}
 
@@ -194,34 +498,285 @@ int32_t host_mem_manager_read_mem_space(uint32_t core, barelog_event_t **events)
 	}
 #endif
 
-	int8_t ret = 0;
-	(void) ret;
-	*events = calloc(BARELOG_EVENT_PER_CORE_SHR_MEM_MAX, sizeof(barelog_event_t));
-	uint32_t n = BARELOG_EVENT_PER_CORE_SHR_MEM_MAX; // real number of events read;
+	uint32_t size = BARELOG_HOST_READ_BATCH;
+	int32_t n = 0; // real number of events read;
+	int32_t ret = 0;
+
+	*events = malloc(size * sizeof(barelog_event_t));
+
+	/* The buffer grows as long as the core has records left to read. */
+	while (*events != NULL) {
+		ret = host_mem_manager_read_new(core, &(manager.cursors[core]), &((*events)[n]), size - n);
+		if (ret < 0) {
+			free(*events);
+			*events = NULL;
+			return ret;
+		}
+		n += ret;
+		if ((uint32_t) n < size) {
+			return n;
+		}
+		size *= 2;
+		barelog_event_t *grown = realloc(*events, size * sizeof(barelog_event_t));
+		if (grown == NULL) {
+			free(*events);
+		}
+		*events = grown;
+	}
 
-	barelog_try_mutex(core);
-	barelog_set_mutex(core, 1);
-	const void *base = manager.mem_space[core].base; // On lit du cote host donc on lit dans les @virtuelles !
-	ret = manager.read(base, BARELOG_EVENT_PER_CORE_SHR_MEM_MAX*sizeof(barelog_event_t), (void *) (*events));
+	return BARELOG_ERR;
+}
+
+int8_t host_mem_manager_cursor_init(uint32_t core, barelog_host_cursor_t *cursor) {
 
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
-	if (ret != BARELOG_SUCCESS) {
-		barelog_set_mutex(core, 0);
+	if (core >= manager.header.nb_cores) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (cursor == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	barelog_shared_ring_t *ring = (barelog_shared_ring_t *) manager.mem_space[BARELOG_RING_I].base + core;
+
+	memset(cursor, 0, sizeof(barelog_host_cursor_t));
+	cursor->sequence = BARELOG_SEQUENCE_UNKNOWN;
+	if (manager.read(&(ring->tail), sizeof(uint32_t), &(cursor->position)) != BARELOG_SUCCESS) {
 		return BARELOG_SHRMEM_READ_ERR;
 	}
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t host_mem_manager_read_new(uint32_t core, barelog_host_cursor_t *cursor,
+		barelog_event_t *events, uint32_t max) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= manager.header.nb_cores) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (cursor == NULL || (events == NULL && max)) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
 #endif
-	barelog_set_mutex(core, 0);
 
-	for (uint32_t i = 0; i < BARELOG_EVENT_PER_CORE_SHR_MEM_MAX; ++i) {
-		if (strlen((*events)[i].data) == 0) { // FIXME test a ameliorer
-			n = i;
-			break;
+	// On lit du cote host donc on lit dans les @virtuelles !
+	barelog_shared_ring_t *ring = (barelog_shared_ring_t *) manager.mem_space[BARELOG_RING_I].base + core;
+	const uint8_t *shared_records = manager.mem_space[core].base;
+	uint32_t segment = BARELOG_CHUNK_NONE; // segment of the chunk looked up
+	uint32_t control[2]; // head and oldest counters
+	uint32_t counters[BARELOG_HOST_READ_BATCH]; // counters of the records of a batch
+	barelog_record_header_t header;
+	uint32_t n = 0; // real number of events read;
+	const uint32_t ring_size = manager.header.ring_size;
+	const uint32_t ring_mask = ring_size - 1;
+	/* The records are never split between two segments (chunks). */
+	const uint32_t segment_size = (manager.header.chunk_size) ? manager.header.chunk_size : ring_size;
+
+	if (manager.read(&(ring->head), sizeof(control), control) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	barelog_memory_barrier();
+
+	/* Only the records published by the core (and not overwritten) are read. */
+	const uint32_t head = control[0];
+	const uint32_t start = cursor->position;
+	uint32_t counter = start;
+	if ((int32_t) (control[1] - counter) > 0) {
+		counter = control[1];
+	}
+	if ((int32_t) (head - counter) < 0 || head - counter > ring_size) {
+		counter = head;
+	}
+	if ((int32_t) (counter - start) > 0) {
+		cursor->overwritten += counter - start;
+	}
+
+	while (n < max && counter != head) {
+		const uint32_t first = n;
+		uint32_t batch = 0;
+
+		/* The records are copied one by one, in the order of their counters. */
+		while (batch < BARELOG_HOST_READ_BATCH && n < max && counter != head) {
+			const uint32_t offset = counter & (segment_size - 1);
+			if (offset + BARELOG_RECORD_HEADER_SIZE > segment_size) {
+				counter += segment_size - offset;
+				continue;
+			}
+			if (manager.header.chunk_size && counter - offset != segment) {
+				segment = counter - offset;
+				shared_records = pool_chunk(core, segment);
+				if (shared_records == NULL) {
+					/* Chunk given back (overwritten) : resynchronizes on oldest. */
+					segment = BARELOG_CHUNK_NONE;
+					break;
+				}
+			}
+			if (manager.read(&(shared_records[offset]), BARELOG_RECORD_HEADER_SIZE, &header) != BARELOG_SUCCESS) {
+				return BARELOG_SHRMEM_READ_ERR;
+			}
+			if (header.length == BARELOG_RECORD_SKIP) {
+				counter += segment_size - offset;
+				continue;
+			}
+			if (header.length > BARELOG_BUF_MAX_SIZE
+				|| BARELOG_RECORD_SIZE(header.length) > head - counter) {
+				/* Invalid record (overwritten while being read) : resynchronizes on oldest. */
+				break;
+			}
+			if (header.info & BARELOG_RECORD_EPOCH) {
+				if (header.length != sizeof(uint32_t) || manager.read(&(shared_records[offset + BARELOG_RECORD_HEADER_SIZE]),
+					sizeof(uint32_t), &(cursor->epoch)) != BARELOG_SUCCESS) {
+					return BARELOG_SHRMEM_READ_ERR;
+				}
+				cursor->timestamp = header.timestamp;
+				counter += BARELOG_RECORD_SIZE(header.length);
+				continue;
+			}
+			/* A wrap whose epoch marker was lost (e.g. skipped by the core). */
+			if (header.timestamp < cursor->timestamp) {
+				++cursor->epoch;
+			}
+			cursor->timestamp = header.timestamp;
+			if (manager.read(&(shared_records[offset + BARELOG_RECORD_HEADER_SIZE]),
+				header.length, events[n].data) != BARELOG_SUCCESS) {
+				return BARELOG_SHRMEM_READ_ERR;
+			}
+			memset(&(events[n].data[header.length]), 0, BARELOG_BUF_MAX_SIZE - header.length);
+			uint64_t timestamp = ((uint64_t) cursor->epoch << 32) | header.timestamp;
+			host_sync_correct(core, &timestamp);
+			events[n].timestamp = timestamp;
+			events[n].core = core;
+			events[n].length = header.length;
+			events[n].sequence = header.sequence;
+			events[n].level = header.info & BARELOG_RECORD_LEVEL_MASK;
+			events[n].flags = header.info & ~BARELOG_RECORD_LEVEL_MASK;
+			counters[batch++] = counter;
+			counter += BARELOG_RECORD_SIZE(header.length);
+			++n;
+		}
+
+		/* The records overwritten by the core during the copy are dropped. */
+		barelog_memory_barrier();
+		if (manager.read(&(ring->oldest), sizeof(uint32_t), &(control[1])) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_READ_ERR;
+		}
+		const uint32_t valid = (batch) ? counters[0] : counter;
+		if ((int32_t) (control[1] - valid) > 0) {
+			uint32_t dropped = 0;
+			while (dropped < batch && (int32_t) (control[1] - counters[dropped]) > 0) {
+				++dropped;
+			}
+			memmove(&(events[first]), &(events[first + dropped]), (batch - dropped) * sizeof(barelog_event_t));
+			n -= dropped;
+			if ((int32_t) (control[1] - counter) > 0) {
+				counter = ((int32_t) (head - control[1]) > 0) ? control[1] : head;
+			}
+			cursor->overwritten += ((int32_t) (control[1] - counter) > 0) ? counter - valid : control[1] - valid;
+		} else if (batch < BARELOG_HOST_READ_BATCH && n < max && counter != head) {
+			/* Invalid record not explained by an overwrite : skips the rest. */
+			cursor->overwritten += head - counter;
+			counter = head;
 		}
+
+		/* The gaps between the sequence numbers of the events delivered
+		 * are the events lost (whatever the reason). */
+		for (uint32_t i = first; i < n; ++i) {
+			if (cursor->sequence != BARELOG_SEQUENCE_UNKNOWN) {
+				cursor->lost += (uint16_t) (events[i].sequence - cursor->sequence);
+			}
+			cursor->sequence = (uint16_t) (events[i].sequence + 1);
+		}
+	}
+
+	if ((int32_t) (counter - start) > 0) {
+		cursor->wraps += ((start & ring_mask) + (counter - start)) / ring_size;
+	}
+	cursor->position = counter;
+
+	/* Releases the records read (and the chunks they were stored into). */
+	if (manager.write(&(ring->tail), sizeof(uint32_t), &counter) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	if (manager.header.chunk_size && pool_release(core, start, counter) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
 	}
 
 	return n;
 }
 
+int8_t host_mem_manager_sync_request(uint32_t core, uint32_t request) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= manager.header.nb_cores) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	barelog_sync_beacon_t *beacon = (barelog_sync_beacon_t *) manager.mem_space[BARELOG_SYNC_I].base + core;
+
+	if (manager.write(&(beacon->request), sizeof(uint32_t), &request) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_mem_manager_sync_reply(uint32_t core, barelog_sync_beacon_t *beacon) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= manager.header.nb_cores) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (beacon == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	const barelog_sync_beacon_t *shared = (barelog_sync_beacon_t *) manager.mem_space[BARELOG_SYNC_I].base + core;
+
+	/* The clock is only read once the reply is seen. */
+	if (manager.read(&(shared->reply), sizeof(uint32_t), &(beacon->reply)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	barelog_memory_barrier();
+	if (manager.read(&(shared->epoch), 2 * sizeof(uint32_t), &(beacon->epoch)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_mem_manager_core_stats(uint32_t core, barelog_core_stats_t *stats) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= manager.header.nb_cores) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (stats == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	/* Also used by the writer, whatever the functioning modes. */
+	if (!manager.initialized) {
+		return BARELOG_INIT_ERR;
+	}
+
+	const barelog_core_stats_t *shared = (barelog_core_stats_t *) manager.mem_space[BARELOG_STATS_I].base + core;
+
+	if (manager.read(shared, sizeof(barelog_core_stats_t), stats) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
 #if BARELOG_DEBUG_MODE
 int8_t host_mem_manager_read_debug(void) {
 	int8_t ret = BARELOG_SUCCESS;
@@ -0,0 +1,231 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#include "barelog_host_merge.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "barelog_host_mem_manager.h"
+
+/* Number of events buffered at once for each merged core. */
+#define BARELOG_MERGE_BATCH 64
+
+/* Events read from a core and not yet emitted. */
+typedef struct {
+	barelog_host_cursor_t cursor;
+	barelog_event_t events[BARELOG_MERGE_BATCH];
+	uint32_t position;
+	uint32_t length;
+	/* Timestamp of the last event read from the core (if seen). */
+	uint64_t watermark;
+	uint8_t seen;
+	/* Is the core merged ? */
+	uint8_t enabled;
+} merge_input_t;
+
+static struct {
+	uint8_t initialized;
+	merge_input_t *inputs;
+	/* Binary heap of the cores with buffered events, ordered by
+	 * the timestamp of their next event. */
+	uint32_t heap[BARELOG_NB_CORES];
+	uint32_t heap_length;
+} merger;
+
+static inline int8_t earlier(uint64_t a, uint64_t b) {
+	return a < b;
+}
+
+static inline uint64_t next_timestamp(uint32_t core) {
+	const merge_input_t *input = &(merger.inputs[core]);
+	return input->events[input->position].timestamp;
+}
+
+static void heap_sift_down(uint32_t i) {
+	const uint32_t core = merger.heap[i];
+	const uint64_t timestamp = next_timestamp(core);
+
+	for (uint32_t child = 2 * i + 1; child < merger.heap_length; child = 2 * i + 1) {
+		if (child + 1 < merger.heap_length
+			&& earlier(next_timestamp(merger.heap[child + 1]), next_timestamp(merger.heap[child]))) {
+			++child;
+		}
+		if (!earlier(next_timestamp(merger.heap[child]), timestamp)) {
+			break;
+		}
+		merger.heap[i] = merger.heap[child];
+		i = child;
+	}
+	merger.heap[i] = core;
+}
+
+static void heap_push(uint32_t core) {
+	const uint64_t timestamp = next_timestamp(core);
+	uint32_t i = merger.heap_length++;
+
+	while (i > 0 && earlier(timestamp, next_timestamp(merger.heap[(i - 1) / 2]))) {
+		merger.heap[i] = merger.heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	merger.heap[i] = core;
+}
+
+/* Reads the next events of an (emptied) core and pushes it into the heap. */
+static int32_t merge_refill(uint32_t core) {
+	merge_input_t *input = &(merger.inputs[core]);
+	const int32_t n = host_mem_manager_read_new(core, &(input->cursor), input->events, BARELOG_MERGE_BATCH);
+
+	if (n > 0) {
+		input->position = 0;
+		input->length = n;
+		input->watermark = input->events[n - 1].timestamp;
+		input->seen = 1;
+		heap_push(core);
+	}
+
+	return n;
+}
+
+int8_t host_merge_init(const uint32_t *cores, uint32_t nb_cores) {
+	const uint32_t nb_logged = host_mem_manager_nb_cores();
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (merger.initialized) {
+		return BARELOG_INIT_ERR;
+	}
+#endif
+
+	if (cores == NULL) {
+		nb_cores = nb_logged;
+	}
+	for (uint32_t i = 0; cores != NULL && i < nb_cores; ++i) {
+		if (cores[i] >= nb_logged) {
+			return BARELOG_INCONSISTENT_PARAM_ERR;
+		}
+	}
+
+	merger.inputs = calloc(BARELOG_NB_CORES, sizeof(merge_input_t));
+	if (merger.inputs == NULL) {
+		return BARELOG_ERR;
+	}
+
+	for (uint32_t i = 0; i < nb_cores; ++i) {
+		const uint32_t core = (cores != NULL) ? cores[i] : i;
+		if (host_mem_manager_cursor_init(core, &(merger.inputs[core].cursor)) != BARELOG_SUCCESS) {
+			free(merger.inputs);
+			merger.inputs = NULL;
+			return BARELOG_SHRMEM_READ_ERR;
+		}
+		merger.inputs[core].enabled = 1;
+	}
+	merger.heap_length = 0;
+	merger.initialized = 1;
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t host_merge_read(barelog_event_t *events, uint32_t max, uint8_t flush) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!merger.initialized) {
+		return BARELOG_INIT_ERR;
+	}
+
+	if (events == NULL && max) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	uint32_t n = 0;
+	uint64_t bound = 0; // earliest watermark of the emptied cores
+	uint8_t bounded = 0;
+	uint8_t blocked = 0; // an emptied core has never logged
+
+	/* The emptied cores are refilled, the others bound the emitted events. */
+	for (uint32_t core = 0; core < BARELOG_NB_CORES; ++core) {
+		merge_input_t *input = &(merger.inputs[core]);
+		if (!input->enabled || input->position < input->length) {
+			continue;
+		}
+		const int32_t ret = merge_refill(core);
+		if (ret < 0) {
+			return ret;
+		}
+		if (ret == 0) {
+			if (!input->seen) {
+				blocked = 1;
+			} else if (!bounded || earlier(input->watermark, bound)) {
+				bound = input->watermark;
+				bounded = 1;
+			}
+		}
+	}
+
+	while (n < max && merger.heap_length && (flush || !blocked)) {
+		const uint32_t core = merger.heap[0];
+		merge_input_t *input = &(merger.inputs[core]);
+
+		if (!flush && bounded && earlier(bound, next_timestamp(core))) {
+			break;
+		}
+
+		events[n++] = input->events[input->position++];
+		if (input->position < input->length) {
+			heap_sift_down(0);
+			continue;
+		}
+
+		/* The core is emptied : it is refilled or it bounds the next events. */
+		merger.heap[0] = merger.heap[--merger.heap_length];
+		if (merger.heap_length) {
+			heap_sift_down(0);
+		}
+		const int32_t ret = merge_refill(core);
+		if (ret < 0) {
+			return ret;
+		}
+		if (ret == 0 && (!bounded || earlier(input->watermark, bound))) {
+			bound = input->watermark;
+			bounded = 1;
+		}
+	}
+
+	return n;
+}
+
+int8_t host_merge_finalize(void) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!merger.initialized) {
+		return BARELOG_INIT_ERR;
+	}
+#endif
+
+	free(merger.inputs);
+	merger.inputs = NULL;
+	merger.heap_length = 0;
+	merger.initialized = 0;
+
+	return BARELOG_SUCCESS;
+}
@@ -0,0 +1,413 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#include "barelog_host_sites.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+#include "barelog_event.h"
+
+/* Log sites loaded from the target's program. */
+static struct {
+	barelog_site_t *sites;
+	uint32_t nb_sites;
+} table;
+
+/* Section header of an ELF32 or ELF64 file. */
+typedef struct {
+	uint32_t name;
+	uint32_t type;
+	uint64_t flags;
+	uint64_t addr;
+	uint64_t offset;
+	uint64_t size;
+	uint32_t link;
+} section_t;
+
+/* ELF file loaded in memory. */
+typedef struct {
+	uint8_t *data;
+	size_t size;
+	uint8_t is_64;
+	uint64_t shoff;
+	uint16_t shnum;
+	uint16_t shstrndx;
+} elf_t;
+
+static int8_t elf_section(const elf_t *elf, uint32_t i, section_t *section) {
+	if (elf->is_64) {
+		Elf64_Shdr shdr;
+		if (elf->shoff + (i + 1) * sizeof(shdr) > elf->size) {
+			return BARELOG_ERR;
+		}
+		memcpy(&shdr, elf->data + elf->shoff + i * sizeof(shdr), sizeof(shdr));
+		section->name = shdr.sh_name;
+		section->type = shdr.sh_type;
+		section->flags = shdr.sh_flags;
+		section->addr = shdr.sh_addr;
+		section->offset = shdr.sh_offset;
+		section->size = shdr.sh_size;
+		section->link = shdr.sh_link;
+	} else {
+		Elf32_Shdr shdr;
+		if (elf->shoff + (i + 1) * sizeof(shdr) > elf->size) {
+			return BARELOG_ERR;
+		}
+		memcpy(&shdr, elf->data + elf->shoff + i * sizeof(shdr), sizeof(shdr));
+		section->name = shdr.sh_name;
+		section->type = shdr.sh_type;
+		section->flags = shdr.sh_flags;
+		section->addr = shdr.sh_addr;
+		section->offset = shdr.sh_offset;
+		section->size = shdr.sh_size;
+		section->link = shdr.sh_link;
+	}
+
+	if (section->type != SHT_NOBITS && section->offset + section->size > elf->size) {
+		return BARELOG_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+/* RELATIVE relocation of a pointer of the log sites section. */
+typedef struct {
+	uint64_t offset;
+	uint64_t addend;
+} relocation_t;
+
+/* Relocations of the log sites section, sorted by offset. */
+typedef struct {
+	relocation_t *entries;
+	uint64_t nb_entries;
+} relocations_t;
+
+static int relocation_compare(const void *a, const void *b) {
+	const uint64_t x = ((const relocation_t *) a)->offset;
+	const uint64_t y = ((const relocation_t *) b)->offset;
+	return (x > y) - (x < y);
+}
+
+/* Indexes the RELATIVE relocations applied to a section of the target's
+ * program. Position independent programs store their pointers into such
+ * relocations instead of the section itself. */
+static int8_t elf_relocations(const elf_t *elf, const section_t *section,
+	relocations_t *relocations) {
+	relocations->entries = NULL;
+	relocations->nb_entries = 0;
+
+	const uint64_t entry_size = elf->is_64 ? sizeof(Elf64_Rela) : sizeof(Elf32_Rela);
+	uint64_t nb_max = 0;
+	section_t rela;
+	for (uint32_t i = 0; i < elf->shnum; ++i) {
+		if (elf_section(elf, i, &rela) == BARELOG_SUCCESS && rela.type == SHT_RELA) {
+			nb_max += rela.size / entry_size;
+		}
+	}
+	if (!nb_max) {
+		return BARELOG_SUCCESS;
+	}
+
+	relocations->entries = malloc(nb_max * sizeof(relocation_t));
+	if (!relocations->entries) {
+		return BARELOG_ERR;
+	}
+
+	for (uint32_t i = 0; i < elf->shnum; ++i) {
+		if (elf_section(elf, i, &rela) != BARELOG_SUCCESS || rela.type != SHT_RELA) {
+			continue;
+		}
+		for (uint64_t off = 0; off + entry_size <= rela.size; off += entry_size) {
+			relocation_t entry;
+			uint8_t relative;
+			if (elf->is_64) {
+				Elf64_Rela rel;
+				memcpy(&rel, elf->data + rela.offset + off, sizeof(rel));
+				entry.offset = rel.r_offset;
+				entry.addend = rel.r_addend;
+				relative = (ELF64_R_SYM(rel.r_info) == 0);
+			} else {
+				Elf32_Rela rel;
+				memcpy(&rel, elf->data + rela.offset + off, sizeof(rel));
+				entry.offset = rel.r_offset;
+				entry.addend = (uint32_t) rel.r_addend;
+				relative = (ELF32_R_SYM(rel.r_info) == 0);
+			}
+			if (relative && entry.offset >= section->addr
+				&& entry.offset < section->addr + section->size) {
+				relocations->entries[relocations->nb_entries++] = entry;
+			}
+		}
+	}
+
+	qsort(relocations->entries, relocations->nb_entries, sizeof(relocation_t), relocation_compare);
+
+	return BARELOG_SUCCESS;
+}
+
+/* Reads a pointer stored at a given address of the target's program, applying
+ * its relocation if any. */
+static uint64_t elf_read_pointer(const elf_t *elf, const section_t *section,
+	const relocations_t *relocations, uint64_t address) {
+	const relocation_t key = { .offset = address };
+	const relocation_t *entry = (relocations->nb_entries) ? bsearch(&key, relocations->entries,
+		relocations->nb_entries, sizeof(relocation_t), relocation_compare) : NULL;
+	if (entry) {
+		return entry->addend;
+	}
+
+	uint64_t value = 0;
+	memcpy(&value, elf->data + section->offset + (address - section->addr), elf->is_64 ? 8 : 4);
+
+	return value;
+}
+
+/* Duplicates the string located at a given address of the target's program. */
+static char *elf_strdup(const elf_t *elf, uint64_t address) {
+	section_t section;
+	for (uint32_t i = 0; i < elf->shnum; ++i) {
+		if (elf_section(elf, i, &section) != BARELOG_SUCCESS
+			|| !(section.flags & SHF_ALLOC) || section.type == SHT_NOBITS) {
+			continue;
+		}
+		if (address >= section.addr && address < section.addr + section.size) {
+			const char *s = (const char *) elf->data + section.offset + (address - section.addr);
+			const size_t max = section.size - (address - section.addr);
+			const char *end = memchr(s, '\0', max);
+			size_t n = (end) ? (size_t) (end - s) : max;
+			char *copy = malloc(n + 1);
+			if (copy) {
+				memcpy(copy, s, n);
+				copy[n] = '\0';
+			}
+			return copy;
+		}
+	}
+
+	return NULL;
+}
+
+static int8_t elf_open(const char *path, elf_t *elf) {
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		return BARELOG_ERR;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size < (long) sizeof(Elf32_Ehdr)) {
+		fclose(file);
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	elf->size = size;
+	elf->data = malloc(elf->size);
+	if (!elf->data || fread(elf->data, 1, elf->size, file) != elf->size) {
+		free(elf->data);
+		fclose(file);
+		return BARELOG_ERR;
+	}
+	fclose(file);
+
+	const uint16_t endianness = 1;
+	const uint8_t host_data = (*(const uint8_t *) &endianness) ? ELFDATA2LSB : ELFDATA2MSB;
+	if (memcmp(elf->data, ELFMAG, SELFMAG) != 0 || elf->data[EI_DATA] != host_data) {
+		free(elf->data);
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	elf->is_64 = (elf->data[EI_CLASS] == ELFCLASS64);
+	if (elf->is_64) {
+		Elf64_Ehdr ehdr;
+		if (elf->size < sizeof(ehdr)) {
+			free(elf->data);
+			return BARELOG_INCONSISTENT_PARAM_ERR;
+		}
+		memcpy(&ehdr, elf->data, sizeof(ehdr));
+		elf->shoff = ehdr.e_shoff;
+		elf->shnum = ehdr.e_shnum;
+		elf->shstrndx = ehdr.e_shstrndx;
+	} else {
+		Elf32_Ehdr ehdr;
+		memcpy(&ehdr, elf->data, sizeof(ehdr));
+		elf->shoff = ehdr.e_shoff;
+		elf->shnum = ehdr.e_shnum;
+		elf->shstrndx = ehdr.e_shstrndx;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t host_sites_load(const char *elf_path) {
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!elf_path) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	elf_t elf;
+	int8_t ret = elf_open(elf_path, &elf);
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+
+	section_t strtab;
+	section_t section;
+	uint8_t found = 0;
+	if (elf_section(&elf, elf.shstrndx, &strtab) == BARELOG_SUCCESS) {
+		for (uint32_t i = 0; i < elf.shnum && !found; ++i) {
+			if (elf_section(&elf, i, &section) == BARELOG_SUCCESS
+				&& section.name < strtab.size
+				&& strncmp((const char *) elf.data + strtab.offset + section.name,
+					BARELOG_SITE_SECTION, strtab.size - section.name) == 0) {
+				found = 1;
+			}
+		}
+	}
+
+	/* Layout of barelog_site_t on the target (see its alignment). */
+	const uint32_t pointer_size = elf.is_64 ? 8 : 4;
+	const uint32_t site_size = 4 * pointer_size;
+	if (!found || section.type == SHT_NOBITS || section.size % site_size) {
+		free(elf.data);
+		return (found) ? BARELOG_INCONSISTENT_PARAM_ERR : 0;
+	}
+
+	/* The events only hold 16 bits site ids. */
+	if (section.size / site_size > BARELOG_MAX_SITES) {
+		free(elf.data);
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	relocations_t relocations;
+	if (elf_relocations(&elf, &section, &relocations) != BARELOG_SUCCESS) {
+		free(elf.data);
+		return BARELOG_ERR;
+	}
+
+	host_sites_unload();
+
+	table.nb_sites = section.size / site_size;
+	table.sites = calloc(table.nb_sites, sizeof(barelog_site_t));
+	if (!table.sites) {
+		table.nb_sites = 0;
+		free(relocations.entries);
+		free(elf.data);
+		return BARELOG_ERR;
+	}
+
+	for (uint32_t i = 0; i < table.nb_sites; ++i) {
+		const uint64_t address = section.addr + i * site_size;
+		uint32_t fields[2];
+		memcpy(fields, elf.data + section.offset + i * site_size + 2 * pointer_size, sizeof(fields));
+		table.sites[i].format = elf_strdup(&elf, elf_read_pointer(&elf, &section, &relocations, address));
+		table.sites[i].file = elf_strdup(&elf, elf_read_pointer(&elf, &section, &relocations, address + pointer_size));
+		table.sites[i].line = fields[0];
+		table.sites[i].lvl = fields[1];
+	}
+
+	free(relocations.entries);
+	free(elf.data);
+
+#if BARELOG_BINARY_MODE
+	barelog_set_site_resolver(host_sites_get);
+#endif
+
+	return table.nb_sites;
+}
+
+int32_t host_sites_symbol_size(const char *elf_path, const char *symbol) {
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!elf_path || !symbol) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	elf_t elf;
+	int8_t ret = elf_open(elf_path, &elf);
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+
+	/* Looks for the function into the symbol table (if not stripped). */
+	int32_t size = 0;
+	section_t symtab;
+	section_t strtab;
+	for (uint32_t i = 0; i < elf.shnum && !size; ++i) {
+		if (elf_section(&elf, i, &symtab) != BARELOG_SUCCESS || symtab.type != SHT_SYMTAB
+			|| elf_section(&elf, symtab.link, &strtab) != BARELOG_SUCCESS) {
+			continue;
+		}
+		const uint64_t entry_size = elf.is_64 ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+		for (uint64_t off = 0; off + entry_size <= symtab.size && !size; off += entry_size) {
+			uint32_t name;
+			uint8_t info;
+			uint64_t symbol_size;
+			if (elf.is_64) {
+				Elf64_Sym sym;
+				memcpy(&sym, elf.data + symtab.offset + off, sizeof(sym));
+				name = sym.st_name;
+				info = sym.st_info;
+				symbol_size = sym.st_size;
+			} else {
+				Elf32_Sym sym;
+				memcpy(&sym, elf.data + symtab.offset + off, sizeof(sym));
+				name = sym.st_name;
+				info = sym.st_info;
+				symbol_size = sym.st_size;
+			}
+			if (ELF64_ST_TYPE(info) == STT_FUNC && name < strtab.size
+				&& strncmp((const char *) elf.data + strtab.offset + name, symbol,
+					strtab.size - name) == 0) {
+				size = (symbol_size > INT32_MAX) ? INT32_MAX : (int32_t) symbol_size;
+			}
+		}
+	}
+
+	free(elf.data);
+
+	return size;
+}
+
+const barelog_site_t *host_sites_get(uint32_t core, uint16_t site_id) {
+	(void) core;
+	if (site_id >= table.nb_sites) {
+		return NULL;
+	}
+
+	return &(table.sites[site_id]);
+}
+
+void host_sites_unload(void) {
+	for (uint32_t i = 0; i < table.nb_sites; ++i) {
+		free((char *) table.sites[i].format);
+		free((char *) table.sites[i].file);
+	}
+	free(table.sites);
+	table.sites = NULL;
+	table.nb_sites = 0;
+}
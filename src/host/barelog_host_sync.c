@@ -0,0 +1,271 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime()
+
+#include "barelog_host_sync.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "barelog_buffer.h"
+#include "barelog_host_mem_manager.h"
+
+/* Number of requests whose sending time is kept (a core may answer
+ * one of the previous requests). */
+#define BARELOG_SYNC_SENT 4
+
+/* Synchronization state of a core. The sums of the least-squares fit are
+ * computed relative to the first sample, to preserve their precision. */
+typedef struct {
+	uint32_t request;
+	uint32_t answered;
+	uint64_t sent[BARELOG_SYNC_SENT];
+	/* Shortest interval between a request and its answer */
+	uint64_t window;
+	uint32_t samples;
+	double time0;
+	double clock0;
+	double sum_time;
+	double sum_clock;
+	double sum_time2;
+	double sum_time_clock;
+} sync_core_t;
+
+/* Estimation of the clock of a core, with the conversion of its timestamps
+ * into the clock of the reference core (cycles = scale * timestamp + shift). */
+typedef struct {
+	uint8_t valid;
+	barelog_sync_estimate_t estimate;
+	double scale;
+	double shift;
+} sync_cache_t;
+
+/* The estimations are computed by host_sync_poll and read by the drainer
+ * threads : they are published under a sequence lock (odd while updated). */
+static struct {
+	uint8_t started;
+	uint8_t correction;
+	struct timespec origin;
+	sync_core_t cores[BARELOG_NB_CORES];
+	uint32_t sequence;
+	sync_cache_t cache[BARELOG_NB_CORES];
+} sync;
+
+static uint64_t host_time(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) (now.tv_sec - sync.origin.tv_sec) * 1000000000
+		+ now.tv_nsec - sync.origin.tv_nsec;
+}
+
+static void sync_sample(sync_core_t *state, double time, double clock) {
+	if (!state->samples) {
+		state->time0 = time;
+		state->clock0 = clock;
+	}
+	time -= state->time0;
+	clock -= state->clock0;
+	state->sum_time += time;
+	state->sum_clock += clock;
+	state->sum_time2 += time * time;
+	state->sum_time_clock += time * clock;
+	++state->samples;
+}
+
+static uint8_t sync_fit(const sync_core_t *state, barelog_sync_estimate_t *estimate) {
+	const double n = state->samples;
+	const double det = n * state->sum_time2 - state->sum_time * state->sum_time;
+
+	if (state->samples < 2 || det <= 0) {
+		return 0;
+	}
+
+	const double rate = (n * state->sum_time_clock - state->sum_time * state->sum_clock) / det;
+	estimate->samples = state->samples;
+	estimate->rate = rate;
+	estimate->offset = state->clock0 + (state->sum_clock - rate * state->sum_time) / n
+		- rate * state->time0;
+
+	return 1;
+}
+
+/* Computes the estimations of all the cores and their conversion into the
+ * clock of the reference core (the first one whose clock is estimated). */
+static void sync_update(void) {
+	const sync_cache_t *reference = NULL;
+
+	__atomic_store_n(&(sync.sequence), sync.sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	for (uint32_t core = 0; core < host_mem_manager_nb_cores(); ++core) {
+		sync_cache_t *cache = &(sync.cache[core]);
+
+		cache->valid = sync_fit(&(sync.cores[core]), &(cache->estimate));
+		if (cache->valid && reference == NULL) {
+			reference = cache;
+		}
+	}
+
+	for (uint32_t core = 0; core < host_mem_manager_nb_cores(); ++core) {
+		sync_cache_t *cache = &(sync.cache[core]);
+
+		if (cache->valid) {
+			cache->scale = reference->estimate.rate / cache->estimate.rate;
+			cache->shift = reference->estimate.offset - cache->scale * cache->estimate.offset;
+		}
+	}
+
+	__atomic_store_n(&(sync.sequence), sync.sequence + 1, __ATOMIC_RELEASE);
+}
+
+/* Reads the estimation of a core as published by the last update. */
+static uint8_t sync_read(uint32_t core, sync_cache_t *cache) {
+	uint32_t sequence;
+
+	do {
+		sequence = __atomic_load_n(&(sync.sequence), __ATOMIC_ACQUIRE);
+		*cache = sync.cache[core];
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((sequence & 1) || sequence != __atomic_load_n(&(sync.sequence), __ATOMIC_RELAXED));
+
+	return cache->valid;
+}
+
+int32_t host_sync_poll(void) {
+	barelog_sync_beacon_t beacon;
+	int32_t n = 0;
+
+	if (!sync.started) {
+		clock_gettime(CLOCK_MONOTONIC, &(sync.origin));
+		sync.started = 1;
+	}
+
+	for (uint32_t core = 0; core < host_mem_manager_nb_cores(); ++core) {
+		sync_core_t *state = &(sync.cores[core]);
+
+		if (state->request) {
+			if (host_mem_manager_sync_reply(core, &beacon) != BARELOG_SUCCESS) {
+				return BARELOG_SHRMEM_READ_ERR;
+			}
+			const uint64_t now = host_time();
+			/* Only the answers to the last requests sent are kept, the shortest
+			 * intervals (at most twice the shortest one) bounding the sample. */
+			if (beacon.reply != state->answered && state->request - beacon.reply < BARELOG_SYNC_SENT) {
+				const uint64_t sent = state->sent[beacon.reply % BARELOG_SYNC_SENT];
+				const uint64_t window = now - sent;
+				state->answered = beacon.reply;
+				if (!state->window || window < state->window) {
+					state->window = window;
+				}
+				if (window <= 2 * state->window) {
+					sync_sample(state, sent + window / 2.0,
+						(double) (((uint64_t) beacon.epoch << 32) | beacon.timestamp));
+					++n;
+				}
+			}
+		}
+
+		if (++state->request == 0) {
+			++state->request;
+		}
+		state->sent[state->request % BARELOG_SYNC_SENT] = host_time();
+		if (host_mem_manager_sync_request(core, state->request) != BARELOG_SUCCESS) {
+			return BARELOG_SHRMEM_WRITE_ERR;
+		}
+	}
+
+	if (n) {
+		sync_update();
+	}
+
+	return n;
+}
+
+int8_t host_sync_estimate(uint32_t core, barelog_sync_estimate_t *estimate) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= BARELOG_NB_CORES) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (estimate == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	sync_cache_t cache;
+
+	if (!sync_read(core, &cache)) {
+		return BARELOG_ERR;
+	}
+	*estimate = cache.estimate;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_sync_to_ns(uint32_t core, uint64_t timestamp, int64_t *time) {
+	barelog_sync_estimate_t estimate;
+	int8_t ret = host_sync_estimate(core, &estimate);
+
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+	*time = (int64_t) (((double) timestamp - estimate.offset) / estimate.rate);
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_sync_to_cycles(uint32_t core, uint64_t timestamp, uint64_t *cycles) {
+	sync_cache_t cache;
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core >= BARELOG_NB_CORES) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (cycles == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	if (!sync_read(core, &cache)) {
+		return BARELOG_ERR;
+	}
+
+	const double clock = cache.scale * (double) timestamp + cache.shift;
+	*cycles = (clock > 0) ? (uint64_t) clock : 0;
+
+	return BARELOG_SUCCESS;
+}
+
+void host_sync_set_correction(uint8_t enable) {
+	sync.correction = enable;
+}
+
+void host_sync_correct(uint32_t core, uint64_t *timestamp) {
+	if (sync.correction) {
+		host_sync_to_cycles(core, *timestamp, timestamp);
+	}
+}
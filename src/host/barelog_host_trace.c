@@ -0,0 +1,457 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_trace.c
+ * @brief Module implementing the reading of the trace files.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#define _POSIX_C_SOURCE 200112L // mmap, pthread
+
+#include "barelog_host_trace.h"
+#include "barelog_host_codec.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Returns the record at a position of a block, or NULL once the block is over. */
+static inline const barelog_trace_record_t *record_at(const barelog_trace_t *trace,
+	const uint8_t *block, uint32_t position) {
+	const uint32_t block_size = trace->header->block_size;
+	const barelog_trace_record_t *record = (const barelog_trace_record_t *) &(block[position]);
+
+	if (block_size - position < sizeof(barelog_trace_record_t)
+		|| record->length == BARELOG_RECORD_SKIP
+		|| record->length > trace->header->max_length
+		|| block_size - position < BARELOG_TRACE_RECORD_SIZE(record->length)) {
+		return NULL;
+	}
+
+	return record;
+}
+
+/* Returns the records of a block, decoding it into buffer if the trace is
+ * compressed (decoded holding the offset of the block the buffer holds). */
+static const uint8_t *chunk_records(const barelog_trace_t *trace, const barelog_trace_chunk_t *chunk,
+	uint8_t *buffer, uint64_t *decoded) {
+	const barelog_trace_block_t *block = (const barelog_trace_block_t *) &(trace->base[chunk->offset]);
+
+	if (!(trace->header->flags & BARELOG_TRACE_COMPRESSED)) {
+		return (const uint8_t *) block;
+	}
+
+	if (*decoded != chunk->offset) {
+		*decoded = 0;
+		if (block->size < sizeof(barelog_trace_block_t) || block->size > chunk->size
+			|| host_codec_decode((const uint8_t *) block + sizeof(barelog_trace_block_t),
+				block->size - sizeof(barelog_trace_block_t), buffer,
+				trace->header->block_size) != (int32_t) block->used) {
+			return NULL;
+		}
+		if (block->used + sizeof(barelog_trace_record_t) <= trace->header->block_size) {
+			((barelog_trace_record_t *) &(buffer[block->used]))->length = BARELOG_RECORD_SKIP;
+		}
+		*decoded = chunk->offset;
+	}
+
+	return buffer;
+}
+
+/* Returns the size taken by the block at an offset of the file, 0 if
+ * there is none. A block starting with zeroes was not written yet. */
+static uint32_t block_size_at(const barelog_trace_t *trace, uint64_t offset) {
+	static const barelog_trace_record_t unwritten;
+	const barelog_segment_header_t *header = trace->header;
+
+	if (!(header->flags & BARELOG_TRACE_COMPRESSED)) {
+		return (offset + header->block_size <= trace->size
+			&& memcmp(&(trace->base[offset]), &unwritten, sizeof(barelog_trace_record_t))) ? header->block_size : 0;
+	}
+
+	if (offset + sizeof(barelog_trace_block_t) > trace->size) {
+		return 0;
+	}
+	const barelog_trace_block_t *block = (const barelog_trace_block_t *) &(trace->base[offset]);
+	const uint64_t size = ((uint64_t) block->size + BARELOG_WRITER_ALIGNMENT - 1) & ~((uint64_t) BARELOG_WRITER_ALIGNMENT - 1);
+
+	return (block->size >= sizeof(barelog_trace_block_t) && offset + size <= trace->size) ? size : 0;
+}
+
+/* Part of the blocks of a file whose index entries are rebuilt by a thread. */
+typedef struct {
+	const barelog_trace_t *trace;
+	barelog_trace_chunk_t *chunks;
+	uint32_t n;
+	int8_t ret;
+} trace_scan_part_t;
+
+/* Fills the index entries of a part of the blocks (whose offset and size are set). */
+static void *trace_scan_part(void *param) {
+	trace_scan_part_t *part = (trace_scan_part_t *) param;
+	const barelog_trace_t *trace = part->trace;
+	uint8_t *buffer = NULL;
+	uint64_t decoded = 0;
+
+	part->ret = BARELOG_SUCCESS;
+	if ((trace->header->flags & BARELOG_TRACE_COMPRESSED)
+		&& (buffer = malloc(trace->header->block_size)) == NULL) {
+		part->ret = BARELOG_ERR;
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < part->n; ++i) {
+		barelog_trace_chunk_t *chunk = &(part->chunks[i]);
+		const uint8_t *records = chunk_records(trace, chunk, buffer, &decoded);
+		const barelog_trace_record_t *record;
+
+		/* A corrupted block is kept empty. */
+		while (records != NULL && (record = record_at(trace, records, chunk->used)) != NULL) {
+			const uint64_t timestamp = record->timestamp;
+			if (timestamp < chunk->min) {
+				chunk->min = timestamp;
+			}
+			if (timestamp > chunk->max) {
+				chunk->max = timestamp;
+			}
+			chunk->cores |= UINT64_C(1) << (record->core % 64);
+			++chunk->events;
+			chunk->used += BARELOG_TRACE_RECORD_SIZE(record->length);
+		}
+	}
+	free(buffer);
+
+	return NULL;
+}
+
+/* Rebuilds the index of a file without footer by scanning its blocks : the
+ * blocks are first located, then parsed (decoded) by several threads. */
+static int8_t trace_scan(barelog_trace_t *trace) {
+	const barelog_segment_header_t *header = trace->header;
+	uint32_t max_chunks = 64;
+	barelog_trace_chunk_t *chunks = malloc(max_chunks * sizeof(barelog_trace_chunk_t));
+	uint64_t offset = header->blocks_offset;
+	uint32_t size;
+	uint32_t n = 0;
+
+	if (chunks == NULL) {
+		return BARELOG_ERR;
+	}
+
+	for (; (size = block_size_at(trace, offset)) != 0; ++n) {
+		if (n == max_chunks) {
+			barelog_trace_chunk_t *grown = realloc(chunks, 2 * max_chunks * sizeof(barelog_trace_chunk_t));
+			if (grown == NULL) {
+				free(chunks);
+				return BARELOG_ERR;
+			}
+			chunks = grown;
+			max_chunks *= 2;
+		}
+
+		barelog_trace_chunk_t *chunk = &(chunks[n]);
+		memset(chunk, 0, sizeof(barelog_trace_chunk_t));
+		chunk->offset = offset;
+		chunk->size = size;
+		chunk->min = UINT64_MAX;
+		offset += size;
+	}
+
+	const long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t nb_parts = (nb_cpus > 1) ? nb_cpus : 1;
+	if (nb_parts > BARELOG_TRACE_SCAN_THREADS) {
+		nb_parts = BARELOG_TRACE_SCAN_THREADS;
+	}
+	if (nb_parts > n / 2) {
+		nb_parts = (n / 2) ? n / 2 : 1;
+	}
+
+	trace_scan_part_t parts[BARELOG_TRACE_SCAN_THREADS];
+	pthread_t threads[BARELOG_TRACE_SCAN_THREADS];
+	uint32_t started = 0;
+	int8_t ret = BARELOG_SUCCESS;
+	for (uint32_t i = 0; i < nb_parts; ++i) {
+		parts[i].trace = trace;
+		parts[i].chunks = &(chunks[(uint64_t) n * i / nb_parts]);
+		parts[i].n = (uint64_t) n * (i + 1) / nb_parts - (uint64_t) n * i / nb_parts;
+	}
+	/* The first part is parsed by the calling thread. */
+	for (uint32_t i = 1; i < nb_parts; ++i, ++started) {
+		if (pthread_create(&(threads[i]), NULL, trace_scan_part, &(parts[i]))) {
+			break;
+		}
+	}
+	trace_scan_part(&(parts[0]));
+	for (uint32_t i = 1; i <= started; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+	for (uint32_t i = 1 + started; i < nb_parts; ++i) {
+		trace_scan_part(&(parts[i]));
+	}
+	for (uint32_t i = 0; i < nb_parts; ++i) {
+		if (parts[i].ret != BARELOG_SUCCESS) {
+			ret = parts[i].ret;
+		}
+	}
+	if (ret != BARELOG_SUCCESS) {
+		free(chunks);
+		return ret;
+	}
+
+	trace->chunks = chunks;
+	trace->nb_chunks = n;
+	trace->scanned = 1;
+
+	return BARELOG_SUCCESS;
+}
+
+/* Loads the index from the footer of the file, if any. */
+static int8_t trace_index(barelog_trace_t *trace) {
+	const barelog_trace_footer_t *footer;
+
+	if (trace->size < trace->header->blocks_offset + sizeof(barelog_trace_footer_t)) {
+		return BARELOG_ERR;
+	}
+
+	footer = (const barelog_trace_footer_t *) &(trace->base[trace->size - sizeof(barelog_trace_footer_t)]);
+	if (memcmp(footer->magic, BARELOG_INDEX_MAGIC, sizeof(BARELOG_INDEX_MAGIC))
+		|| footer->index_offset < trace->header->blocks_offset
+		|| footer->index_offset > trace->size - sizeof(barelog_trace_footer_t)
+		|| footer->nb_chunks > (trace->size - sizeof(barelog_trace_footer_t) - footer->index_offset)
+			/ sizeof(barelog_trace_chunk_t)
+		|| footer->nb_stats > (trace->size - sizeof(barelog_trace_footer_t) - footer->index_offset
+			- footer->nb_chunks * sizeof(barelog_trace_chunk_t)) / sizeof(barelog_core_stats_t)) {
+		return BARELOG_ERR;
+	}
+
+	trace->chunks = (const barelog_trace_chunk_t *) &(trace->base[footer->index_offset]);
+	trace->nb_chunks = footer->nb_chunks;
+
+	for (uint32_t i = 0; i < trace->nb_chunks; ++i) {
+		if (trace->chunks[i].offset < trace->header->blocks_offset
+			|| trace->chunks[i].offset + trace->chunks[i].size > footer->index_offset
+			|| (!(trace->header->flags & BARELOG_TRACE_COMPRESSED)
+				&& trace->chunks[i].size != trace->header->block_size)) {
+			return BARELOG_ERR;
+		}
+	}
+
+	trace->stats = (footer->nb_stats) ? (const barelog_core_stats_t *) &(trace->chunks[trace->nb_chunks]) : NULL;
+	trace->nb_stats = footer->nb_stats;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_trace_open(const char *path, barelog_trace_t *trace) {
+	struct stat st;
+	void *base;
+	int fd;
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (path == NULL || trace == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	memset(trace, 0, sizeof(barelog_trace_t));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return BARELOG_INIT_ERR;
+	}
+	if (fstat(fd, &st) || (size_t) st.st_size < sizeof(barelog_segment_header_t)) {
+		close(fd);
+		return BARELOG_INIT_ERR;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		return BARELOG_INIT_ERR;
+	}
+
+	trace->base = base;
+	trace->size = st.st_size;
+	trace->header = (const barelog_segment_header_t *) base;
+
+	const barelog_segment_header_t *header = trace->header;
+	if (memcmp(header->magic, BARELOG_SEGMENT_MAGIC, sizeof(BARELOG_SEGMENT_MAGIC))
+		|| header->version != BARELOG_SEGMENT_VERSION
+		|| header->record_size != sizeof(barelog_trace_record_t)
+		|| header->record_alignment != BARELOG_RECORD_ALIGNMENT
+		|| header->max_length > BARELOG_BUF_MAX_SIZE
+		|| header->block_size < sizeof(barelog_trace_record_t)
+		|| header->blocks_offset < sizeof(barelog_segment_header_t)
+		|| header->blocks_offset > trace->size) {
+		host_trace_close(trace);
+		return BARELOG_EVENT_CONVERSION_ERR;
+	}
+
+	if (header->flags & BARELOG_TRACE_COMPRESSED) {
+		trace->block = malloc(header->block_size);
+		if (trace->block == NULL) {
+			host_trace_close(trace);
+			return BARELOG_ERR;
+		}
+	}
+
+	if (trace_index(trace) != BARELOG_SUCCESS && trace_scan(trace) != BARELOG_SUCCESS) {
+		host_trace_close(trace);
+		return BARELOG_ERR;
+	}
+
+	trace->reach = malloc(2 * ((trace->nb_chunks) ? trace->nb_chunks : 1) * sizeof(uint64_t));
+	if (trace->reach == NULL) {
+		host_trace_close(trace);
+		return BARELOG_ERR;
+	}
+	trace->until = &(trace->reach[trace->nb_chunks]);
+	for (uint32_t i = 0; i < trace->nb_chunks; ++i) {
+		const uint64_t max = trace->chunks[i].max;
+		trace->reach[i] = (i && trace->reach[i - 1] > max) ? trace->reach[i - 1] : max;
+	}
+	for (uint32_t i = trace->nb_chunks; i-- > 0;) {
+		const uint64_t min = trace->chunks[i].min;
+		trace->until[i] = (i + 1 < trace->nb_chunks && trace->until[i + 1] < min) ? trace->until[i + 1] : min;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_trace_close(barelog_trace_t *trace) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (trace == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	if (trace->scanned) {
+		free((void *) trace->chunks);
+	}
+	free(trace->reach);
+	free(trace->block);
+	if (trace->base != NULL && munmap((void *) trace->base, trace->size)) {
+		return BARELOG_ERR;
+	}
+	memset(trace, 0, sizeof(barelog_trace_t));
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_trace_seek(barelog_trace_t *trace, uint64_t from, uint64_t to,
+	barelog_trace_iter_t *iter) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (trace == NULL || iter == NULL || trace->base == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+
+	if (from > to) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	uint32_t low = 0;
+	uint32_t high = trace->nb_chunks;
+
+	/* The chunks before the first one reaching from (reach is sorted) only
+	 * hold earlier events, and so do the chunks from the first one whose
+	 * following ones all start after to (until is sorted). */
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		if (trace->reach[middle] < from) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	iter->chunk = low;
+
+	high = trace->nb_chunks;
+	while (low < high) {
+		const uint32_t middle = low + (high - low) / 2;
+		if (trace->until[middle] <= to) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	iter->end = low;
+
+	iter->trace = trace;
+	iter->from = from;
+	iter->to = to;
+	iter->cores = UINT64_MAX;
+	iter->position = 0;
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t host_trace_read(barelog_trace_iter_t *iter, barelog_event_t *events, uint32_t max) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (iter == NULL || iter->trace == NULL || (events == NULL && max)) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	barelog_trace_t *trace = iter->trace;
+	uint32_t n = 0;
+
+	while (n < max && iter->chunk < iter->end) {
+		const barelog_trace_chunk_t *chunk = &(trace->chunks[iter->chunk]);
+		const uint8_t *records = NULL;
+		const barelog_trace_record_t *record;
+
+		if (chunk->max < iter->from || chunk->min > iter->to || !(chunk->cores & iter->cores)
+			|| (records = chunk_records(trace, chunk, trace->block, &(trace->decoded))) == NULL
+			|| (record = record_at(trace, records, iter->position)) == NULL) {
+			++iter->chunk;
+			iter->position = 0;
+			continue;
+		}
+
+		const uint64_t timestamp = record->timestamp;
+		if (timestamp >= iter->from && timestamp <= iter->to
+			&& (iter->cores & (UINT64_C(1) << (record->core % 64)))) {
+			events[n].timestamp = timestamp;
+			events[n].core = record->core;
+			events[n].length = record->length;
+			events[n].sequence = record->sequence;
+			events[n].level = record->level;
+			events[n].flags = record->flags;
+			memcpy(events[n].data, (const uint8_t *) record + sizeof(barelog_trace_record_t), record->length);
+			++n;
+		}
+		iter->position += BARELOG_TRACE_RECORD_SIZE(record->length);
+	}
+
+	return n;
+}
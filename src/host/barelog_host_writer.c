@@ -0,0 +1,543 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#define _GNU_SOURCE // O_DIRECT
+
+#include "barelog_host_writer.h"
+#include "barelog_host_codec.h"
+#include "barelog_host_mem_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Maximum length of the paths of the segment files (prefix excluded). */
+#define BARELOG_SEGMENT_SUFFIX_SIZE 32
+
+/* Size (in bytes) of the buffer holding the encoding of a block, padding included. */
+#define BARELOG_WRITER_PACKED_SIZE \
+	((sizeof(barelog_trace_block_t) + BARELOG_CODEC_BOUND(BARELOG_WRITER_BLOCK_SIZE) \
+		+ BARELOG_WRITER_ALIGNMENT - 1) & ~(BARELOG_WRITER_ALIGNMENT - 1))
+
+/* Time (in microseconds) the writer thread sleeps when the queues are empty. */
+#define BARELOG_WRITER_PERIOD 100
+
+/* Queue of a producer : as for barelog_event_buffer_t, head and tail are
+ * free-running byte counters and a record is never split. */
+typedef struct {
+	uint8_t *buffer;
+	/* counter of the bytes pushed (written by the producer) */
+	uint32_t head;
+	/* counter of the bytes written into the blocks (written by the writer thread) */
+	uint32_t tail;
+	uint64_t stalls;
+} writer_queue_t;
+
+static struct {
+	uint8_t opened;
+	uint8_t closing;
+	uint8_t failed;
+	int8_t ret;
+	barelog_writer_config_t config;
+	writer_queue_t *queues;
+	pthread_t thread;
+	/* Block being filled, written at once into the current segment */
+	uint8_t *block;
+	uint32_t used;
+	/* Encoding of the block (if compressed) */
+	uint8_t *packed;
+	/* Index entry of the block being filled */
+	barelog_trace_chunk_t chunk;
+	/* Index of the current segment */
+	barelog_trace_chunk_t *chunks;
+	uint32_t nb_chunks;
+	uint32_t max_chunks;
+	/* Current segment */
+	int fd;
+	char *path;
+	uint32_t segment;
+	uint64_t segment_bytes;
+	struct timespec segment_start;
+	/* Is the current segment over (the next block opening a new one) ? */
+	uint8_t rotating;
+	/* Maximum number of segments kept (0 for all) */
+	uint32_t kept;
+	barelog_writer_stats_t stats;
+} writer;
+
+/* First (aligned) bytes of the segment files, holding their header. */
+static uint8_t segment_header[BARELOG_WRITER_ALIGNMENT] __attribute__ ((aligned(BARELOG_WRITER_ALIGNMENT)));
+
+static inline void stat_add(uint64_t *stat, uint64_t value) {
+	__atomic_store_n(stat, __atomic_load_n(stat, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static void segment_path(uint32_t index) {
+	snprintf(writer.path, strlen(writer.config.prefix) + BARELOG_SEGMENT_SUFFIX_SIZE,
+		"%s.%06u.blseg", writer.config.prefix, index);
+}
+
+static int8_t write_all(const uint8_t *data, size_t size) {
+	while (size) {
+		const ssize_t n = write(writer.fd, data, size);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return BARELOG_ERR;
+		}
+		data += n;
+		size -= n;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+static void chunk_reset(void) {
+	memset(&(writer.chunk), 0, sizeof(barelog_trace_chunk_t));
+	writer.chunk.min = UINT64_MAX;
+}
+
+static int8_t segment_open(void) {
+	barelog_segment_header_t *header = (barelog_segment_header_t *) segment_header;
+
+	segment_path(writer.segment);
+	writer.fd = open(writer.path, O_WRONLY | O_CREAT | O_TRUNC | (writer.config.direct ? O_DIRECT : 0), 0644);
+	if (writer.fd < 0) {
+		return BARELOG_INIT_ERR;
+	}
+
+	memset(segment_header, 0, BARELOG_WRITER_ALIGNMENT);
+	memcpy(header->magic, BARELOG_SEGMENT_MAGIC, sizeof(BARELOG_SEGMENT_MAGIC));
+	header->version = BARELOG_SEGMENT_VERSION;
+	header->block_size = BARELOG_WRITER_BLOCK_SIZE;
+	header->blocks_offset = BARELOG_WRITER_ALIGNMENT;
+	header->index = writer.segment;
+	header->nb_cores = (host_mem_manager_nb_cores()) ? host_mem_manager_nb_cores() : BARELOG_NB_CORES;
+	header->flags = ((BARELOG_BINARY_MODE) ? BARELOG_TRACE_BINARY : 0)
+		| ((writer.config.compress) ? BARELOG_TRACE_COMPRESSED : 0);
+	header->record_size = sizeof(barelog_trace_record_t);
+	header->record_alignment = BARELOG_RECORD_ALIGNMENT;
+	header->max_length = BARELOG_BUF_MAX_SIZE;
+	header->clock_rate = writer.config.clock_rate;
+	if (write_all(segment_header, BARELOG_WRITER_ALIGNMENT) != BARELOG_SUCCESS) {
+		close(writer.fd);
+		writer.fd = -1;
+		return BARELOG_ERR;
+	}
+	writer.segment_bytes = 0;
+	writer.nb_chunks = 0;
+	clock_gettime(CLOCK_MONOTONIC, &(writer.segment_start));
+	__atomic_store_n(&(writer.stats.segments), writer.stats.segments + 1, __ATOMIC_RELAXED);
+
+	/* The oldest segments are removed to keep within the budget. */
+	if (writer.kept && writer.segment >= writer.kept) {
+		segment_path(writer.segment - writer.kept);
+		if (unlink(writer.path) == 0) {
+			__atomic_store_n(&(writer.stats.removed), writer.stats.removed + 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+/* Writes the index of the current segment and the statistics of the cores
+ * (padded, the footer ending the file) and closes it. */
+static int8_t segment_close(void) {
+	const size_t size = (writer.nb_chunks * sizeof(barelog_trace_chunk_t) + BARELOG_NB_CORES * sizeof(barelog_core_stats_t)
+		+ sizeof(barelog_trace_footer_t) + BARELOG_WRITER_ALIGNMENT - 1) & ~((size_t) BARELOG_WRITER_ALIGNMENT - 1);
+	uint8_t *index = NULL;
+	int8_t ret = BARELOG_SUCCESS;
+
+	if (writer.fd < 0) {
+		return BARELOG_SUCCESS;
+	}
+
+	if (posix_memalign((void **) &index, BARELOG_WRITER_ALIGNMENT, size)) {
+		ret = BARELOG_ERR;
+	} else {
+		barelog_trace_footer_t *footer = (barelog_trace_footer_t *) &(index[size - sizeof(barelog_trace_footer_t)]);
+		memset(index, 0, size);
+		memcpy(index, writer.chunks, writer.nb_chunks * sizeof(barelog_trace_chunk_t));
+		footer->index_offset = BARELOG_WRITER_ALIGNMENT + writer.segment_bytes;
+		footer->nb_chunks = writer.nb_chunks;
+		/* The statistics are only known if the cores are drained by this host. */
+		barelog_core_stats_t *stats = (barelog_core_stats_t *) &(index[writer.nb_chunks * sizeof(barelog_trace_chunk_t)]);
+		footer->nb_stats = host_mem_manager_nb_cores();
+		for (uint32_t i = 0; i < footer->nb_stats; ++i) {
+			if (host_mem_manager_core_stats(i, &(stats[i])) != BARELOG_SUCCESS) {
+				memset(stats, 0, BARELOG_NB_CORES * sizeof(barelog_core_stats_t));
+				footer->nb_stats = 0;
+				break;
+			}
+		}
+		memcpy(footer->magic, BARELOG_INDEX_MAGIC, sizeof(BARELOG_INDEX_MAGIC));
+		ret = write_all(index, size);
+		free(index);
+	}
+	close(writer.fd);
+	writer.fd = -1;
+
+	return ret;
+}
+
+static int8_t segment_rotate(void) {
+	if (segment_close() != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+	++writer.segment;
+	writer.rotating = 0;
+	return segment_open();
+}
+
+/* Writes the current block (padded, compressed if enabled) into the current
+ * segment, the segments being rotated only once a new block is written
+ * (no empty segment). */
+static int8_t block_flush(void) {
+	if (!writer.used) {
+		return BARELOG_SUCCESS;
+	}
+
+	if ((writer.rotating || writer.segment_bytes >= writer.config.segment_size)
+		&& segment_rotate() != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+
+	if (writer.nb_chunks == writer.max_chunks) {
+		const uint32_t max_chunks = (writer.max_chunks) ? 2 * writer.max_chunks : 64;
+		barelog_trace_chunk_t *chunks = realloc(writer.chunks, max_chunks * sizeof(barelog_trace_chunk_t));
+		if (chunks == NULL) {
+			return BARELOG_ERR;
+		}
+		writer.chunks = chunks;
+		writer.max_chunks = max_chunks;
+	}
+	const uint8_t *data = writer.block;
+	uint32_t size = BARELOG_WRITER_BLOCK_SIZE;
+	if (writer.config.compress) {
+		barelog_trace_block_t *block = (barelog_trace_block_t *) writer.packed;
+		const int32_t encoded = host_codec_encode(writer.block, writer.used,
+			writer.packed + sizeof(barelog_trace_block_t));
+		if (encoded < 0) {
+			return BARELOG_ERR;
+		}
+		block->size = sizeof(barelog_trace_block_t) + encoded;
+		block->used = writer.used;
+		size = (block->size + BARELOG_WRITER_ALIGNMENT - 1) & ~(BARELOG_WRITER_ALIGNMENT - 1);
+		memset(&(writer.packed[block->size]), 0, size - block->size);
+		data = writer.packed;
+	} else {
+		if (BARELOG_WRITER_BLOCK_SIZE - writer.used >= sizeof(barelog_trace_record_t)) {
+			((barelog_trace_record_t *) &(writer.block[writer.used]))->length = BARELOG_RECORD_SKIP;
+			writer.used += sizeof(barelog_trace_record_t);
+		}
+		memset(&(writer.block[writer.used]), 0, BARELOG_WRITER_BLOCK_SIZE - writer.used);
+	}
+
+	writer.chunk.offset = BARELOG_WRITER_ALIGNMENT + writer.segment_bytes;
+	writer.chunk.size = size;
+	writer.chunk.used = writer.used;
+	writer.chunks[writer.nb_chunks++] = writer.chunk;
+	chunk_reset();
+
+	if (write_all(data, size) != BARELOG_SUCCESS) {
+		return BARELOG_ERR;
+	}
+	writer.used = 0;
+	writer.segment_bytes += size;
+	stat_add(&(writer.stats.blocks), 1);
+	stat_add(&(writer.stats.stored), size);
+
+	return BARELOG_SUCCESS;
+}
+
+/* Moves the records pushed into a queue into the blocks. */
+static int32_t queue_drain(writer_queue_t *queue) {
+	const uint32_t mask = writer.config.queue_size - 1;
+	const uint32_t head = __atomic_load_n(&(queue->head), __ATOMIC_ACQUIRE);
+	uint32_t tail = queue->tail;
+	int32_t n = 0;
+
+	while (tail != head) {
+		const uint32_t position = tail & mask;
+		const barelog_trace_record_t *record = (const barelog_trace_record_t *) &(queue->buffer[position]);
+		if (writer.config.queue_size - position < sizeof(barelog_trace_record_t)
+			|| record->length == BARELOG_RECORD_SKIP) {
+			tail += writer.config.queue_size - position;
+			continue;
+		}
+
+		const uint32_t size = BARELOG_TRACE_RECORD_SIZE(record->length);
+		if (writer.used + size > BARELOG_WRITER_BLOCK_SIZE && block_flush() != BARELOG_SUCCESS) {
+			return BARELOG_ERR;
+		}
+		/* The padding is zeroed, as expected by the codec. */
+		memcpy(&(writer.block[writer.used]), record, sizeof(barelog_trace_record_t) + record->length);
+		memset(&(writer.block[writer.used + sizeof(barelog_trace_record_t) + record->length]), 0,
+			size - sizeof(barelog_trace_record_t) - record->length);
+		writer.used += size;
+		if (record->timestamp < writer.chunk.min) {
+			writer.chunk.min = record->timestamp;
+		}
+		if (record->timestamp > writer.chunk.max) {
+			writer.chunk.max = record->timestamp;
+		}
+		writer.chunk.cores |= UINT64_C(1) << (record->core % 64);
+		++writer.chunk.events;
+		stat_add(&(writer.stats.bytes), size);
+		tail += size;
+		++n;
+	}
+	__atomic_store_n(&(queue->tail), tail, __ATOMIC_RELEASE);
+	stat_add(&(writer.stats.events), n);
+
+	return n;
+}
+
+static void *writer_thread(void *param) {
+	(void) param;
+	uint8_t last = 0;
+	int8_t ret = BARELOG_SUCCESS;
+
+	/* Once closing, a last pass writes what was pushed meanwhile. */
+	while (!last && ret == BARELOG_SUCCESS) {
+		int32_t moved = 0;
+		last = __atomic_load_n(&(writer.closing), __ATOMIC_ACQUIRE);
+		for (uint32_t i = 0; i < writer.config.nb_producers && ret == BARELOG_SUCCESS; ++i) {
+			const int32_t n = queue_drain(&(writer.queues[i]));
+			if (n < 0) {
+				ret = n;
+			}
+			moved += n;
+		}
+
+		if (ret == BARELOG_SUCCESS && writer.config.segment_period) {
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			if (now.tv_sec - writer.segment_start.tv_sec >= writer.config.segment_period) {
+				ret = block_flush();
+				writer.rotating = (writer.segment_bytes != 0);
+				writer.segment_start = now;
+			}
+		}
+
+		if (!moved && !last) {
+			usleep(BARELOG_WRITER_PERIOD);
+		}
+	}
+
+	if (ret == BARELOG_SUCCESS) {
+		ret = block_flush();
+	}
+	const int8_t closed = segment_close();
+	if (ret == BARELOG_SUCCESS) {
+		ret = closed;
+	}
+	writer.ret = ret;
+	__atomic_store_n(&(writer.failed), ret != BARELOG_SUCCESS, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+static void writer_free(void) {
+	if (writer.queues) {
+		for (uint32_t i = 0; i < writer.config.nb_producers; ++i) {
+			free(writer.queues[i].buffer);
+		}
+	}
+	free(writer.queues);
+	free(writer.block);
+	free(writer.packed);
+	free(writer.path);
+	free(writer.chunks);
+	writer.queues = NULL;
+	writer.block = NULL;
+	writer.packed = NULL;
+	writer.path = NULL;
+	writer.chunks = NULL;
+}
+
+int8_t host_writer_open(const barelog_writer_config_t *config) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (config == NULL || config->prefix == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+
+	if (!config->nb_producers || config->queue_size < 2 * BARELOG_TRACE_RECORD_SIZE(BARELOG_BUF_MAX_SIZE)
+		|| (config->queue_size & (config->queue_size - 1))) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	if (writer.opened) {
+		return BARELOG_INIT_ERR;
+	}
+
+	memset(&writer, 0, sizeof(writer));
+	writer.fd = -1;
+	chunk_reset();
+	writer.config = *config;
+	writer.config.segment_size = (config->segment_size + BARELOG_WRITER_BLOCK_SIZE - 1)
+		/ BARELOG_WRITER_BLOCK_SIZE * BARELOG_WRITER_BLOCK_SIZE;
+	if (!writer.config.segment_size) {
+		writer.config.segment_size = BARELOG_WRITER_BLOCK_SIZE;
+	}
+	writer.kept = (config->budget) ? config->budget / writer.config.segment_size : 0;
+	if (config->budget && !writer.kept) {
+		writer.kept = 1;
+	}
+
+	writer.path = malloc(strlen(config->prefix) + BARELOG_SEGMENT_SUFFIX_SIZE);
+	writer.queues = calloc(config->nb_producers, sizeof(writer_queue_t));
+	if (writer.path == NULL || writer.queues == NULL
+		|| posix_memalign((void **) &(writer.block), BARELOG_WRITER_ALIGNMENT, BARELOG_WRITER_BLOCK_SIZE)
+		|| (config->compress && posix_memalign((void **) &(writer.packed), BARELOG_WRITER_ALIGNMENT,
+			BARELOG_WRITER_PACKED_SIZE))) {
+		writer_free();
+		return BARELOG_ERR;
+	}
+	for (uint32_t i = 0; i < config->nb_producers; ++i) {
+		writer.queues[i].buffer = malloc(config->queue_size);
+		if (writer.queues[i].buffer == NULL) {
+			writer_free();
+			return BARELOG_ERR;
+		}
+	}
+
+	int8_t ret = segment_open();
+	if (ret != BARELOG_SUCCESS) {
+		writer_free();
+		return ret;
+	}
+
+	if (pthread_create(&(writer.thread), NULL, writer_thread, NULL)) {
+		segment_close();
+		writer_free();
+		return BARELOG_INIT_ERR;
+	}
+	writer.opened = 1;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t host_writer_push(uint32_t producer, const barelog_event_t *events, uint32_t n) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!writer.opened || producer >= writer.config.nb_producers) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+
+	if (events == NULL && n) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	writer_queue_t *queue = &(writer.queues[producer]);
+	const uint32_t queue_size = writer.config.queue_size;
+	uint32_t head = queue->head;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint16_t length = (events[i].length > BARELOG_BUF_MAX_SIZE) ? BARELOG_BUF_MAX_SIZE : events[i].length;
+		const uint32_t size = BARELOG_TRACE_RECORD_SIZE(length);
+		const uint32_t position = head & (queue_size - 1);
+		const uint32_t padding = (position + size > queue_size) ? queue_size - position : 0;
+
+		/* The pushed records are published before waiting for the writer thread. */
+		if (head + padding + size - __atomic_load_n(&(queue->tail), __ATOMIC_ACQUIRE) > queue_size) {
+			__atomic_store_n(&(queue->head), head, __ATOMIC_RELEASE);
+			stat_add(&(queue->stalls), 1);
+			while (head + padding + size - __atomic_load_n(&(queue->tail), __ATOMIC_ACQUIRE) > queue_size) {
+				if (__atomic_load_n(&(writer.failed), __ATOMIC_ACQUIRE)) {
+					return BARELOG_ERR;
+				}
+				sched_yield();
+			}
+		}
+
+		if (padding >= sizeof(barelog_trace_record_t)) {
+			((barelog_trace_record_t *) &(queue->buffer[position]))->length = BARELOG_RECORD_SKIP;
+		}
+		head += padding;
+
+		barelog_trace_record_t *record = (barelog_trace_record_t *) &(queue->buffer[head & (queue_size - 1)]);
+		record->timestamp = events[i].timestamp;
+		record->core = events[i].core;
+		record->length = length;
+		record->sequence = events[i].sequence;
+		record->level = events[i].level;
+		record->flags = events[i].flags;
+		memcpy((uint8_t *) record + sizeof(barelog_trace_record_t), events[i].data, length);
+		head += size;
+	}
+	__atomic_store_n(&(queue->head), head, __ATOMIC_RELEASE);
+
+	return BARELOG_SUCCESS;
+}
+
+void host_writer_consume(const barelog_drain_batch_t *batch, void *arg) {
+	(void) arg;
+	host_writer_push(batch->thread, batch->events, batch->length);
+}
+
+int8_t host_writer_close(void) {
+
+	if (!writer.opened) {
+		return BARELOG_INIT_ERR;
+	}
+
+	__atomic_store_n(&(writer.closing), 1, __ATOMIC_RELEASE);
+	pthread_join(writer.thread, NULL);
+	writer_free();
+	writer.opened = 0;
+
+	return writer.ret;
+}
+
+int8_t host_writer_stats(barelog_writer_stats_t *stats) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (stats == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	stats->events = __atomic_load_n(&(writer.stats.events), __ATOMIC_RELAXED);
+	stats->bytes = __atomic_load_n(&(writer.stats.bytes), __ATOMIC_RELAXED);
+	stats->blocks = __atomic_load_n(&(writer.stats.blocks), __ATOMIC_RELAXED);
+	stats->stored = __atomic_load_n(&(writer.stats.stored), __ATOMIC_RELAXED);
+	stats->segments = __atomic_load_n(&(writer.stats.segments), __ATOMIC_RELAXED);
+	stats->removed = __atomic_load_n(&(writer.stats.removed), __ATOMIC_RELAXED);
+	stats->stalls = writer.stats.stalls;
+	for (uint32_t i = 0; writer.queues && i < writer.config.nb_producers; ++i) {
+		stats->stalls += __atomic_load_n(&(writer.queues[i].stalls), __ATOMIC_RELAXED);
+	}
+
+	return BARELOG_SUCCESS;
+}
@@ -36,6 +36,12 @@
 #define __BARELOG_HOST_H__
 
 #include "barelog_host_mem_manager.h"
+#include "barelog_host_sites.h"
+#include "barelog_host_drainer.h"
+#include "barelog_host_merge.h"
+#include "barelog_host_sync.h"
+#include "barelog_host_writer.h"
+#include "barelog_host_trace.h"
 #include "barelog_internal.h"
 
 /**
@@ -44,6 +50,16 @@
 #define barelog_host_init(platform, initfct, readfct, writefct, finalizefct) \
 host_mem_manager_init(platform, initfct, readfct, writefct, finalizefct)
 
+/**
+ * @see host_sites_load
+ */
+#define barelog_host_load_sites(elf_path) host_sites_load(elf_path)
+
+/**
+ * @see host_sites_symbol_size
+ */
+#define barelog_host_symbol_size(elf_path, symbol) host_sites_symbol_size(elf_path, symbol)
+
 /**
  * @see host_mem_manager_finalize
  */
@@ -54,6 +70,134 @@ host_mem_manager_init(platform, initfct, readfct, writefct, finalizefct)
  */
 #define barelog_read_log(core, res) host_mem_manager_read_mem_space(core, res)
 
+/**
+ * @see host_mem_manager_cursor_init
+ */
+#define barelog_cursor_init(core, cursor) host_mem_manager_cursor_init(core, cursor)
+
+/**
+ * @see host_mem_manager_read_new
+ */
+#define barelog_read_new(core, cursor, out, max) \
+host_mem_manager_read_new(core, cursor, out, max)
+
+/**
+ * @see host_mem_manager_core_stats
+ */
+#define barelog_core_stats(core, stats) host_mem_manager_core_stats(core, stats)
+
+/**
+ * @see host_mem_manager_set_geometry
+ */
+#define barelog_set_geometry(nb_cores, ring_size, chunk_size) \
+host_mem_manager_set_geometry(nb_cores, ring_size, chunk_size)
+
+/**
+ * @see host_mem_manager_set_test_and_set
+ */
+#define barelog_set_test_and_set(test_and_set) host_mem_manager_set_test_and_set(test_and_set)
+
+/**
+ * @see host_mem_manager_keep_layout
+ */
+#define barelog_keep_layout(keep) host_mem_manager_keep_layout(keep)
+
+/**
+ * @see host_drainer_start
+ */
+#define barelog_drain_start(nb_threads, cpus, consumefct, arg, period) \
+host_drainer_start(nb_threads, cpus, consumefct, arg, period)
+
+/**
+ * @see host_drainer_stop
+ */
+#define barelog_drain_stop() host_drainer_stop()
+
+/**
+ * @see host_drainer_stats
+ */
+#define barelog_drain_stats(stats) host_drainer_stats(stats)
+
+/**
+ * @see host_merge_init
+ */
+#define barelog_merge_init(cores, nb_cores) host_merge_init(cores, nb_cores)
+
+/**
+ * @see host_merge_read
+ */
+#define barelog_merge_read(out, max, flush) host_merge_read(out, max, flush)
+
+/**
+ * @see host_merge_finalize
+ */
+#define barelog_merge_finalize() host_merge_finalize()
+
+/**
+ * @see host_sync_poll
+ */
+#define barelog_sync_poll() host_sync_poll()
+
+/**
+ * @see host_sync_estimate
+ */
+#define barelog_sync_estimate(core, estimate) host_sync_estimate(core, estimate)
+
+/**
+ * @see host_sync_to_ns
+ */
+#define barelog_sync_to_ns(core, timestamp, time) host_sync_to_ns(core, timestamp, time)
+
+/**
+ * @see host_sync_to_cycles
+ */
+#define barelog_sync_to_cycles(core, timestamp, cycles) host_sync_to_cycles(core, timestamp, cycles)
+
+/**
+ * @see host_sync_set_correction
+ */
+#define barelog_sync_set_correction(enable) host_sync_set_correction(enable)
+
+/**
+ * @see host_writer_open
+ */
+#define barelog_writer_open(config) host_writer_open(config)
+
+/**
+ * @see host_writer_push
+ */
+#define barelog_writer_push(producer, events, n) host_writer_push(producer, events, n)
+
+/**
+ * @see host_writer_close
+ */
+#define barelog_writer_close() host_writer_close()
+
+/**
+ * @see host_writer_stats
+ */
+#define barelog_writer_stats(stats) host_writer_stats(stats)
+
+/**
+ * @see host_trace_open
+ */
+#define barelog_trace_open(path, trace) host_trace_open(path, trace)
+
+/**
+ * @see host_trace_seek
+ */
+#define barelog_trace_seek(trace, from, to, iter) host_trace_seek(trace, from, to, iter)
+
+/**
+ * @see host_trace_read
+ */
+#define barelog_trace_read(iter, out, max) host_trace_read(iter, out, max)
+
+/**
+ * @see host_trace_close
+ */
+#define barelog_trace_close(trace) host_trace_close(trace)
+
 #if BARELOG_DEBUG_MODE
 /**
  * @see host_mem_manager_read_debug
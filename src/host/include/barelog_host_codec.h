@@ -0,0 +1,88 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_codec.h
+ * @brief Module compressing the blocks of the trace files.
+ *
+ * A block of records (see barelog_host_trace.h) is encoded as a sequence of
+ * runs of records logged by the same core :
+ *  - the core, the number of records of the run and the sequence number of
+ *    its first record (varints) ;
+ *  - for each record, the difference between its timestamp and the one of
+ *    the previous record (zigzag varint), its level and flags (low byte of
+ *    a varint whose high bits hold the zigzag difference between its
+ *    sequence number and the one following the previous record of the run,
+ *    so that consecutive events take a single byte), the length of its data
+ *    (varint) and its data.
+ * The data is made of tokens : a byte holding the number of literal bytes
+ * (high nibble) and the length of a match minus BARELOG_CODEC_MIN_MATCH (low
+ * nibble), a nibble of 15 being followed by a varint to add. The literal
+ * bytes come next and, unless they complete the data, the distance of the
+ * match (varint) and its extra length. A match copies bytes located earlier
+ * in the decoded block, i.e. the data of the previous events.
+ *
+ * A block is thus decoded in one pass, into a buffer of block_size bytes.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_CODEC__
+#define __BARELOG_HOST_CODEC__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+
+/** Minimum length (in bytes) of a match : */
+#define BARELOG_CODEC_MIN_MATCH 4
+
+/** Number of bits of the hash of the matches candidates : */
+#define BARELOG_CODEC_HASH_BITS 14
+
+/** Maximum size (in bytes) of the encoding of a block holding used bytes of records : */
+#define BARELOG_CODEC_BOUND(used) (2 * (used) + 16)
+
+/**
+ * Encodes the records of a block. The padding of the records must be zeroed.
+ * WARNING : the encoder is not reentrant (it uses a static hash table).
+ * @param block the records to encode.
+ * @param used the size (in bytes) of the records.
+ * @param out the buffer (of at least BARELOG_CODEC_BOUND(used) bytes) in which
+ * to store the encoding.
+ * @return the size (in bytes) of the encoding, an error code if negative.
+ */
+extern int32_t host_codec_encode(const uint8_t *block, uint32_t used, uint8_t *out);
+
+/**
+ * Decodes the records of a block. The padding of the records is zeroed.
+ * @param in the encoding of the records.
+ * @param size the size (in bytes) of the encoding.
+ * @param block the buffer in which to store the records.
+ * @param capacity the size (in bytes) of the buffer.
+ * @return the size (in bytes) of the records, an error code if negative.
+ */
+extern int32_t host_codec_decode(const uint8_t *in, uint32_t size, uint8_t *block, uint32_t capacity);
+
+#endif /* __BARELOG_HOST_CODEC__ */
@@ -0,0 +1,121 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_drainer.h
+ * @brief Module draining the shared memory of the cores with a pool of threads.
+ *
+ * The logged cores are partitioned across a pool of drain threads (each one
+ * optionally pinned on a CPU). Each thread continuously reads the records
+ * published by its cores into a staging buffer of its own and hands the
+ * completed batches to a consumer function.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_DRAINER__
+#define __BARELOG_HOST_DRAINER__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+#include "barelog_event.h"
+
+/**
+ * Batch of events read from a core by a drain thread.
+ * The events belong to the staging buffer of the thread and
+ * are only valid during the call of the consumer function.
+ */
+typedef struct {
+	/** Core which logged the events. */
+	uint32_t core;
+	/** Index of the drain thread which read the events. */
+	uint32_t thread;
+	/** Number of events of the batch. */
+	uint32_t length;
+	/** Events of the batch, in the order of their logging. */
+	const barelog_event_t *events;
+} barelog_drain_batch_t;
+
+/**
+ * Aggregate statistics of the drain threads.
+ */
+typedef struct {
+	/** Number of events drained. */
+	uint64_t events;
+	/** Number of bytes drained from the shared memory. */
+	uint64_t bytes;
+	/** Number of bytes overwritten by the cores before being drained. */
+	uint64_t overwritten;
+	/** Number of events lost by the cores before being drained (see
+	 * barelog_host_cursor_t.lost). */
+	uint64_t lost;
+	/** Number of sweeps over their cores done by the threads. */
+	uint64_t sweeps;
+	/** Time (in seconds) elapsed since the start of the drain. */
+	double elapsed;
+	/** Events drained per second. */
+	double events_rate;
+	/** Bytes drained per second. */
+	double bytes_rate;
+} barelog_drain_stats_t;
+
+/**
+ * Starts the drain threads. The cores are dealt round-robin to the
+ * threads (core i is drained by the thread i % nb_threads).
+ * WARNING : the host memory manager must be initialized and, while
+ * the drain runs, the cores must not be read by other means
+ * (e.g. host_mem_manager_read_mem_space). The read function given to the
+ * manager is then called concurrently by the threads.
+ * @param nb_threads the number of drain threads (at most the number of cores).
+ * @param cpus (optional) the CPU on which to pin each thread (a negative
+ * value leaves the thread unpinned), NULL to pin none of them.
+ * @param consume the function called by the drain threads for each batch of
+ * events. It is called concurrently by the threads, but always from the same
+ * thread for a given core.
+ * @param arg the parameter given to the consume function.
+ * @param period the time (in microseconds) a thread sleeps after a sweep
+ * during which none of its cores had new events.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_drainer_start(uint32_t nb_threads, const int32_t *cpus,
+	void (*consume)(const barelog_drain_batch_t *batch, void *arg), void *arg,
+	uint32_t period) __attribute__ ((cold));
+
+/**
+ * Stops the drain threads, after a last sweep of their cores.
+ * @return BARELOG_SUCCESS if all is clear, the first error met by a thread
+ * otherwise.
+ */
+extern int8_t host_drainer_stop(void) __attribute__ ((cold));
+
+/**
+ * Returns the aggregate statistics of the current (or last) drain.
+ * It may be called while the threads are running.
+ * @param stats the structure in which to store the statistics.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_drainer_stats(barelog_drain_stats_t *stats);
+
+#endif /* __BARELOG_HOST_DRAINER__ */
@@ -43,6 +43,36 @@
 #include "barelog_buffer.h"
 #include "barelog_policy.h"
 
+/** Value of barelog_host_cursor_t.sequence before the first event is read. */
+#define BARELOG_SEQUENCE_UNKNOWN 0x10000
+
+/**
+ * Cursor used to incrementally read the shared ring of a core.
+ * It holds the position of the host in the stream of records written by
+ * the core, so that each reading only copies the records published since
+ * the previous one.
+ * @see host_mem_manager_read_new
+ */
+typedef struct {
+	/** Counter of the next byte to read in the shared ring of the core. */
+	uint32_t position;
+	/** Number of times the readings went past the end of the ring. */
+	uint32_t wraps;
+	/** Number of bytes overwritten by the core before being read. */
+	uint32_t overwritten;
+	/** Number of wraps of the core's clock (see BARELOG_RECORD_EPOCH). */
+	uint32_t epoch;
+	/** Timestamp of the last record read, used to detect the wraps
+	 * whose epoch marker was not read. */
+	uint32_t timestamp;
+	/** Sequence number expected for the next event (or BARELOG_SEQUENCE_UNKNOWN). */
+	uint32_t sequence;
+	/** Number of events lost between the events read (skipped or replaced
+	 * by the core, overwritten before being read...), according to the
+	 * gaps between their sequence numbers. */
+	uint32_t lost;
+} barelog_host_cursor_t;
+
 /**
  * Structure used to hold all of the barelog host manager functions.
  * We use pointers to allow the user to use the functions of their choice,
@@ -51,12 +81,24 @@
 typedef struct {
 	/* State of the host memory manager */
 	uint8_t initialized;
+	/* Layout of the shared memory (see barelog_shared_header_t) */
+	barelog_shared_header_t header;
+	/* Geometry given by host_mem_manager_set_geometry (0 if none) */
+	uint32_t geometry_cores;
+	uint32_t geometry_ring;
+	uint32_t geometry_chunk;
+	/* Keep a valid layout already in shared memory (see host_mem_manager_keep_layout) */
+	uint8_t keep_layout;
 	/* Different shared memory sections to use to store
-	 * events for each logged core. The last mem_space
-	 * is used to reference the location of the mutexes
-	 * bytes in shared memory (if used, see BARELOG_SAFE_MODE flag).
+	 * events for each logged core (only the header.nb_cores first ones
+	 * are used, unless the events are stored into a pool of chunks). The next
+	 * mem_spaces are used to reference the location of the debug section in
+	 * shared memory (if used, see BARELOG_DEBUG_MODE flag) and of the other
+	 * sections described by the header.
 	 */
 	barelog_mem_space_t mem_space[BARELOG_HOST_NB_MEM_SPACE];
+	/* Cursors used by host_mem_manager_read_mem_space for each logged core. */
+	barelog_host_cursor_t cursors[BARELOG_NB_CORES];
 	/**
 	 * Function used to initialize a chunk in the shared memory space.
 	 * @param address the beginning address of the chunk to initialize.
@@ -81,6 +123,14 @@ typedef struct {
 	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
 	 */
 	int8_t (*write)(void *address, size_t size, const void *buffer);
+	/** (Optional) function used by the host to atomically set a word of the
+	 * shared memory, locking the pool of chunks against the cores (see
+	 * host_mem_manager_set_test_and_set).
+	 * @param address the address of the word to set.
+	 * @param previous set to the previous value of the word (0 if free).
+	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+	 */
+	int8_t (*test_and_set)(void *address, uint32_t *previous);
 	/** Function used to finalize a previously initialized chunk of shared memory.
 	 * @param mem_space the mem_space to finalize.
 	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
@@ -88,18 +138,71 @@ typedef struct {
 	int8_t (*finalize)(void *mem_space);
 } barelog_host_mem_manager_t;
 
+/**
+ * Sets the geometry of the shared memory written by the next call to
+ * host_mem_manager_init(), instead of using the default one (BARELOG_NB_CORES
+ * cores sharing BARELOG_EVENT_SHARED_MEM_MAX bytes, by chunks of
+ * BARELOG_SHARED_CHUNK_SIZE bytes if not 0).
+ * With chunks, the memory of the rings of all the cores forms a pool of
+ * chunks, which the cores take on demand and the host gives back once their
+ * records are read : the busiest cores can then use (at least) half of the
+ * pool, while the idle ones use a single chunk.
+ * @param nb_cores the number of cores logged (at most BARELOG_NB_CORES),
+ * 0 to go back to the default behavior.
+ * @param ring_size the size (in bytes) of the ring of records of each core,
+ * a power of two of at least BARELOG_SEGMENT_MIN_SIZE (twice the local
+ * buffer of the cores, so that a whole buffer can always be flushed).
+ * @param chunk_size the size (in bytes) of the chunks of the pool (0 for a
+ * fixed ring per core), a power of two of at least BARELOG_SEGMENT_MIN_SIZE
+ * (always 0 without BARELOG_SHARED_LOCK).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_set_geometry(uint32_t nb_cores, uint32_t ring_size,
+	uint32_t chunk_size) __attribute__ ((cold));
+
+/**
+ * Sets the function used to lock the pool of chunks (see
+ * BARELOG_SHARED_CHUNK_SIZE) against the cores, which have to see the lock
+ * of the host as if it was set with barelog_test_and_set(). If none is given,
+ * the shared memory is expected to be directly addressable by the host (as
+ * with the read and write functions given to host_mem_manager_init()) and
+ * the lock is taken with barelog_test_and_set().
+ * @param test_and_set the function setting a word of the shared memory to 1
+ * and giving its previous value (NULL for the default one).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_set_test_and_set(int8_t (*test_and_set)(void *address,
+	uint32_t *previous)) __attribute__ ((cold));
+
+/**
+ * Makes the next call to host_mem_manager_init() keep the layout already
+ * described by a valid header of the shared memory (e.g. written by the
+ * loader of the board, or by another host program), instead of writing its
+ * own one. The layout is written as usual if there is no such header.
+ * @param keep 1 to keep an existing layout, 0 to always write it (default).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_keep_layout(uint8_t keep) __attribute__ ((cold));
+
 /**
  * Initializes the host's memory manager. Should be called
  * before any subsequent call to any other function in this module.
+ * The layout of the shared memory is described by a header at its
+ * beginning (see barelog_shared_header_t), written once the shared memory
+ * is initialized, so that the number of cores and the size of their rings
+ * are only known at runtime (see host_mem_manager_set_geometry). A valid
+ * header already there is only kept if asked (see
+ * host_mem_manager_keep_layout).
  * @param platform the platform to allocate the (shared) memory spaces against.
  * @param init the function used by the host to initialize a memory section.
  * @param read the function used by the host to read data from a memory section.
  * @param write the function used by the host to write data into a memory section.
  * @param finalize the function used by the host to deallocate a (shared) memory space.
- * @return BARELOG_NB_CORES on success. Otherwise if ret > 0, it is the number of
- * memory segments correctly allocated and if ret < 0 it is an error code.
+ * @return the number of cores logged on success. Otherwise if ret > 0, it is the number of
+ * memory segments correctly allocated and if ret < 0 it is an error code
+ * (BARELOG_INIT_ERR if the layout does not fit this host or the platform).
  */
-extern int8_t host_mem_manager_init(const barelog_platform_t platform,
+extern int32_t host_mem_manager_init(const barelog_platform_t platform,
 	void * (*init)(void * address, size_t size, void * data),
 	int8_t (*read)(const void * address, size_t size, void *buffer),
 	int8_t (*write)(void * address, size_t size, const void *buffer),
@@ -108,14 +211,23 @@ extern int8_t host_mem_manager_init(const barelog_platform_t platform,
 /**
  * Finalizes the host's memory manager. Deallocate all previously allocated
  * (shared) memory segments.
- * @return BARELOG_NB_CORES on success. Otherwise if ret > 0, it is the number of
+ * @return the number of cores logged on success. Otherwise if ret > 0, it is the number of
  * memory segments correctly deallocated and if ret < 0 it indicates an error code.
  */
 extern int8_t host_mem_manager_finalize(void) __attribute__ ((cold, destructor));
 
+/**
+ * Gives the number of cores logged, as described by the header of the
+ * shared memory.
+ * @return the number of cores logged, 0 if the manager is not initialized.
+ */
+extern uint32_t host_mem_manager_nb_cores(void);
+
 /**
  * Reads the memory section dedicated to a core and returns the corresponding
- * events buffer.
+ * events buffer. Only the records published by the core since the previous
+ * reading are returned (the core may still be running) and they are then
+ * released, so that the core can reuse their room.
  * WARNING : it is the responsibility of the caller to free this buffer afterwards.
  * @param core the core on which to read the events.
  * @return the number of events read from shared memory.
@@ -123,6 +235,69 @@ extern int8_t host_mem_manager_finalize(void) __attribute__ ((cold, destructor))
 extern int32_t host_mem_manager_read_mem_space(uint32_t core,
 	barelog_event_t **events);
 
+/**
+ * Initializes a cursor at the position of the oldest record of a core
+ * not yet released by the host.
+ * @param core the core whose shared ring will be read through the cursor.
+ * @param cursor the cursor to initialize.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_cursor_init(uint32_t core,
+	barelog_host_cursor_t *cursor);
+
+/**
+ * Reads at most max of the records published by a core since the previous
+ * reading through the cursor. Only the headers and payloads of these records
+ * are copied from shared memory. The records read are then released so that
+ * the core can reuse their room. The records overwritten by the core before
+ * being read are skipped and accounted in cursor->overwritten, while
+ * cursor->wraps counts the wraparounds of the ring. The number of events
+ * lost before being read, whatever the reason, is accounted in cursor->lost
+ * (a gap of more than 65535 events is however undetectable).
+ * The timestamps of the events are extended to 64 bits with the epoch of the
+ * core's clock, tracked by the cursor through the epoch markers. A cursor
+ * initialized while the core was running, or after records were dropped
+ * (see barelog_policy_t) over several wraps, only knows the exact epoch
+ * from the next marker on.
+ * WARNING : a core's ring has a single consumer. One must not mix readings through
+ * different cursors (or through host_mem_manager_read_mem_space) for a same core.
+ * @param core the core on which to read the events.
+ * @param cursor the cursor holding the reading position (see host_mem_manager_cursor_init).
+ * @param events the buffer (of at least max events) in which to store the events read.
+ * @param max the maximum number of events to read.
+ * @return the number of events read from shared memory, an error code if negative.
+ */
+extern int32_t host_mem_manager_read_new(uint32_t core,
+	barelog_host_cursor_t *cursor, barelog_event_t *events, uint32_t max);
+
+/**
+ * Sends a clock synchronization request to a core.
+ * @see barelog_sync_beacon_t
+ * @param core the core to send the request to.
+ * @param request the sequence number of the request.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_sync_request(uint32_t core, uint32_t request);
+
+/**
+ * Reads the last clock synchronization reply of a core.
+ * @see barelog_sync_beacon_t
+ * @param core the core whose reply to read.
+ * @param beacon set to the reply (the request field is left untouched).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_mem_manager_sync_reply(uint32_t core, barelog_sync_beacon_t *beacon);
+
+/**
+ * Reads the statistics last published by a core (see barelog_core_stats_t),
+ * which tell whether a quiet core is idle or saturated.
+ * @param core the core whose statistics to read.
+ * @param stats set to the statistics of the core.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise
+ * (BARELOG_INIT_ERR if the host memory manager is not initialized).
+ */
+extern int8_t host_mem_manager_core_stats(uint32_t core, barelog_core_stats_t *stats);
+
 #if BARELOG_DEBUG_MODE
 /**
  * Function used to read and display on stderr
@@ -0,0 +1,80 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_merge.h
+ * @brief Module merging the events of all the cores into one timeline.
+ *
+ * The events of each core are read incrementally (see barelog_host_cursor_t)
+ * and merged through a binary heap ordered by their timestamps. Since the
+ * events of a core are ordered, the timestamp of the last event read from
+ * a core is a watermark : the core can no longer log an earlier event. An
+ * event is thus emitted as soon as it is earlier than the watermarks of all
+ * the cores whose events have all been emitted. Only a small batch of events
+ * per core is buffered.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_MERGE__
+#define __BARELOG_HOST_MERGE__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+#include "barelog_event.h"
+
+/**
+ * Initializes the merge of the events of some cores, from the oldest
+ * events not yet read by the host.
+ * WARNING : while the merge is used, the merged cores must not be read by
+ * other means (e.g. host_mem_manager_read_mem_space or the drainer).
+ * @param cores the indexes of the cores to merge, NULL to merge all of the
+ * cores logged (see host_mem_manager_nb_cores).
+ * @param nb_cores the number of indexes in cores (ignored if cores is NULL).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_merge_init(const uint32_t *cores, uint32_t nb_cores) __attribute__ ((cold));
+
+/**
+ * Emits the next events of the global timeline, in the order of their
+ * timestamps. The events which a core could still precede are kept
+ * until the core logs a later event (or until flush is set). Hence, a merged
+ * core which never logs holds the whole timeline back.
+ * @param events the buffer (of at least max events) in which to store the events.
+ * @param max the maximum number of events to emit.
+ * @param flush if not 0, the cores are considered as done with logging : all
+ * the events read are emitted without waiting for the watermarks.
+ * @return the number of events emitted, an error code if negative.
+ */
+extern int32_t host_merge_read(barelog_event_t *events, uint32_t max, uint8_t flush);
+
+/**
+ * Frees the buffers of the merge. The events read but not
+ * yet emitted are lost.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_merge_finalize(void) __attribute__ ((cold));
+
+#endif /* __BARELOG_HOST_MERGE__ */
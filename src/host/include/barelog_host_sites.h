@@ -0,0 +1,78 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_sites.h
+ * @brief Module loading the log sites of a target's program.
+ *
+ * The log sites (see BARELOG_LOG) are stored by the compiler into a dedicated
+ * section of the target's ELF. This module extracts them so that the host can
+ * format the binary events holding a site id.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_SITES__
+#define __BARELOG_HOST_SITES__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+#include "barelog_binary.h"
+
+/**
+ * Loads the log sites of a target's program and registers them as the
+ * site resolver used to format the events.
+ * Loading another program replaces the previously loaded sites.
+ * @param elf_path path to the ELF file of the target's program.
+ * @return the number of sites loaded, or an error code (notably if the
+ * program holds more than BARELOG_MAX_SITES sites).
+ */
+extern int32_t host_sites_load(const char *elf_path) __attribute__ ((cold));
+
+/**
+ * Returns the size of the code of a function of a program, e.g. to follow
+ * the footprint of the logging path of the target (see barelog_bench.h).
+ * @param elf_path path to the ELF file of the program (not stripped).
+ * @param symbol the name of the function.
+ * @return the size (in bytes) of the function, 0 if it is not found,
+ * or an error code.
+ */
+extern int32_t host_sites_symbol_size(const char *elf_path, const char *symbol) __attribute__ ((cold));
+
+/**
+ * Returns a previously loaded log site.
+ * @param core the core which logged the site (unused, all the cores are
+ * expected to run the same program).
+ * @param site_id the id of the site.
+ * @return the site, or NULL if unknown.
+ */
+extern const barelog_site_t *host_sites_get(uint32_t core, uint16_t site_id);
+
+/**
+ * Frees all the previously loaded log sites.
+ */
+extern void host_sites_unload(void) __attribute__ ((cold));
+
+#endif /* __BARELOG_HOST_SITES__ */
@@ -0,0 +1,118 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_sync.h
+ * @brief Module estimating the offset and the drift of the cores' clocks.
+ *
+ * The host regularly sends synchronization requests to the cores, which
+ * answer them with the value of their clock (see barelog_sync()). Each
+ * answer is a sample relating the clock of a core to the time of the
+ * host, taken at the middle of the interval between the request and the
+ * reading of the answer. A least-squares fit of these samples gives the
+ * offset and the rate (i.e. the frequency, drift included) of each core's
+ * clock, used to convert its timestamps into a common time base.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_SYNC__
+#define __BARELOG_HOST_SYNC__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+
+/**
+ * Estimation of the clock of a core relative to the time of the host :
+ * clock = offset + rate * time (time being in nanoseconds since the
+ * first call to host_sync_poll).
+ */
+typedef struct {
+	/** Number of samples used by the estimation. */
+	uint32_t samples;
+	/** Value of the core's clock (in cycles) at the host's time origin. */
+	double offset;
+	/** Cycles of the core's clock per nanosecond of the host. */
+	double rate;
+} barelog_sync_estimate_t;
+
+/**
+ * Collects the answers of the cores to the previous synchronization requests
+ * and sends them new ones. It should be called regularly (and as often as
+ * possible for a better precision) while the cores call barelog_sync().
+ * The estimations of the clocks (and the conversions of their timestamps)
+ * are updated once the samples of all the cores are collected.
+ * @return the number of samples collected, an error code if negative.
+ */
+extern int32_t host_sync_poll(void);
+
+/**
+ * Returns the current estimation of the clock of a core (as of the last
+ * call to host_sync_poll which collected samples).
+ * @param core the core whose clock to estimate.
+ * @param estimate set to the estimation.
+ * @return BARELOG_SUCCESS if all is clear, BARELOG_ERR if not enough samples
+ * were collected yet, an error code otherwise.
+ */
+extern int8_t host_sync_estimate(uint32_t core, barelog_sync_estimate_t *estimate);
+
+/**
+ * Converts a timestamp of a core into the time of the host.
+ * @param core the core which logged the timestamp.
+ * @param timestamp the (64 bits) timestamp to convert.
+ * @param time set to the corresponding time (in nanoseconds since the
+ * first call to host_sync_poll).
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_sync_to_ns(uint32_t core, uint64_t timestamp, int64_t *time);
+
+/**
+ * Converts a timestamp of a core into the clock of the reference core
+ * (the first core whose clock is estimated), i.e. the common time base
+ * in cycles.
+ * @param core the core which logged the timestamp.
+ * @param timestamp the (64 bits) timestamp to convert.
+ * @param cycles set to the corresponding value of the reference clock.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_sync_to_cycles(uint32_t core, uint64_t timestamp, uint64_t *cycles);
+
+/**
+ * Enables (or disables) the conversion of the timestamps of the events read
+ * from shared memory into the common time base (see host_sync_to_cycles).
+ * The timestamps of the cores whose clock is not estimated yet are kept.
+ * @param enable 1 to enable the conversion, 0 to disable it.
+ */
+extern void host_sync_set_correction(uint8_t enable);
+
+/**
+ * Converts a timestamp into the common time base if the conversion is
+ * enabled (see host_sync_set_correction).
+ * @param core the core which logged the timestamp.
+ * @param timestamp the timestamp to convert.
+ */
+extern void host_sync_correct(uint32_t core, uint64_t *timestamp);
+
+#endif /* __BARELOG_HOST_SYNC__ */
@@ -0,0 +1,272 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_trace.h
+ * @brief Module defining the trace files format and reading them.
+ *
+ * A trace file (a segment, see barelog_host_writer.h) is made of :
+ *  - a barelog_segment_header_t, padded to BARELOG_WRITER_ALIGNMENT bytes,
+ *    describing the layout of the file and of the events ;
+ *  - blocks of block_size bytes (the chunks). A block holds records (a
+ *    barelog_trace_record_t followed by length bytes of data, padded to
+ *    record_alignment bytes) up to a record whose length is
+ *    BARELOG_RECORD_SKIP (or up to its end). In a compressed trace (see
+ *    BARELOG_TRACE_COMPRESSED), a block is instead stored as a
+ *    barelog_trace_block_t followed by the encoding of its records (see
+ *    barelog_host_codec.h), padded to BARELOG_WRITER_ALIGNMENT bytes ;
+ *  - an index : one barelog_trace_chunk_t per block, followed by the
+ *    statistics of the cores (see barelog_core_stats_t) when the segment was
+ *    closed, if known, and (at the end of the file) by a
+ *    barelog_trace_footer_t locating them.
+ * All the fields are stored in the byte order of the host which wrote them.
+ *
+ * A trace is read through a memory mapping of the file : only the header,
+ * the index and the blocks overlapping the time range asked for are ever
+ * touched, and the blocks of a compressed trace are decoded one at a time.
+ * The index of a segment still being written (or whose writer was
+ * interrupted) is rebuilt by scanning its blocks, using up to
+ * BARELOG_TRACE_SCAN_THREADS threads.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_TRACE__
+#define __BARELOG_HOST_TRACE__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "barelog_internal.h"
+#include "barelog_event.h"
+#include "barelog_buffer.h"
+
+/** Alignment (in bytes) of the blocks inside the trace files : */
+#define BARELOG_WRITER_ALIGNMENT 4096
+
+/** Magic string at the beginning of the trace files : */
+#define BARELOG_SEGMENT_MAGIC "BARELOG"
+
+/** Magic string at the end of the trace files holding an index : */
+#define BARELOG_INDEX_MAGIC "BLINDEX"
+
+/** Version of the trace files format : */
+#define BARELOG_SEGMENT_VERSION 4
+
+/** Flag of a trace whose events hold binary data (see BARELOG_BINARY_MODE) : */
+#define BARELOG_TRACE_BINARY 0x1
+
+/** Flag of a trace whose blocks are compressed : */
+#define BARELOG_TRACE_COMPRESSED 0x2
+
+/** Size (in bytes) taken inside a block by a record holding length bytes of data : */
+#define BARELOG_TRACE_RECORD_SIZE(length) \
+	((sizeof(barelog_trace_record_t) + (length) + BARELOG_RECORD_ALIGNMENT - 1) & ~(BARELOG_RECORD_ALIGNMENT - 1))
+
+/**
+ * Header of a trace file.
+ */
+typedef struct {
+	/** BARELOG_SEGMENT_MAGIC */
+	char magic[8];
+	/** BARELOG_SEGMENT_VERSION */
+	uint32_t version;
+	/** size (in bytes) of the blocks of the segment (once decoded) */
+	uint32_t block_size;
+	/** offset (in bytes) of the first block of the segment */
+	uint32_t blocks_offset;
+	/** number of the segment since the opening of the writer */
+	uint32_t index;
+	/** number of cores logged (see host_mem_manager_nb_cores) */
+	uint32_t nb_cores;
+	/** flags describing the events (BARELOG_TRACE_BINARY, BARELOG_TRACE_COMPRESSED) */
+	uint32_t flags;
+	/** size (in bytes) of the header of the records */
+	uint16_t record_size;
+	/** alignment (in bytes) of the records inside the blocks */
+	uint16_t record_alignment;
+	/** maximum length (in bytes) of the data of an event */
+	uint32_t max_length;
+	/** number of timestamp units per second (0 if unknown) */
+	uint64_t clock_rate;
+} barelog_segment_header_t;
+
+/**
+ * Header of an event stored into a trace file.
+ */
+typedef struct __attribute__((packed)) {
+	/** timestamp of the event */
+	uint64_t timestamp;
+	/** core on which the event occured */
+	uint16_t core;
+	/** length (in bytes) of the data (or BARELOG_RECORD_SKIP) */
+	uint16_t length;
+	/** sequence number of the event (see barelog_record_header_t) */
+	uint16_t sequence;
+	/** log-level of the event (0 if unknown) */
+	uint8_t level;
+	/** flags of the record of the event */
+	uint8_t flags;
+} barelog_trace_record_t;
+
+/**
+ * Header of a block stored into a compressed trace file.
+ */
+typedef struct {
+	/** size (in bytes) of the block, header included and padding excluded */
+	uint32_t size;
+	/** size (in bytes) of the records of the block once decoded */
+	uint32_t used;
+} barelog_trace_block_t;
+
+/**
+ * Entry of the index of a trace file, describing one of its blocks.
+ */
+typedef struct {
+	/** offset (in bytes) of the block inside the file */
+	uint64_t offset;
+	/** lowest timestamp of the events of the block */
+	uint64_t min;
+	/** highest timestamp of the events of the block */
+	uint64_t max;
+	/** mask of the cores having events in the block (bit core % 64) */
+	uint64_t cores;
+	/** number of events of the block */
+	uint32_t events;
+	/** number of bytes of records of the block */
+	uint32_t used;
+	/** number of bytes taken by the block inside the file */
+	uint32_t size;
+	/** 0 */
+	uint32_t reserved;
+} barelog_trace_chunk_t;
+
+/**
+ * Last bytes of a trace file holding an index.
+ */
+typedef struct {
+	/** offset (in bytes) of the index inside the file */
+	uint64_t index_offset;
+	/** number of entries of the index */
+	uint32_t nb_chunks;
+	/** number of statistics following the index (one per core, or 0) */
+	uint32_t nb_stats;
+	/** BARELOG_INDEX_MAGIC */
+	char magic[8];
+} barelog_trace_footer_t;
+
+/**
+ * Trace file opened for reading.
+ * @see host_trace_open
+ */
+typedef struct {
+	/** Memory mapping of the file. */
+	const uint8_t *base;
+	/** Size (in bytes) of the file. */
+	size_t size;
+	/** Header of the file. */
+	const barelog_segment_header_t *header;
+	/** Index of the file (mapped, or rebuilt by scanning the blocks). */
+	const barelog_trace_chunk_t *chunks;
+	/** Number of entries of the index. */
+	uint32_t nb_chunks;
+	/** Is the index rebuilt (i.e. the file had no footer) ? */
+	uint8_t scanned;
+	/** Statistics of the cores when the segment was closed (indexed by
+	 * core, NULL if unknown). */
+	const barelog_core_stats_t *stats;
+	/** Number of statistics (0 if unknown). */
+	uint32_t nb_stats;
+	/* Highest max of the chunks [0, i] and lowest min of the
+	 * chunks [i, nb_chunks[, used to seek by time. */
+	uint64_t *reach;
+	uint64_t *until;
+	/* Block decoded last (compressed traces only) and its offset. */
+	uint8_t *block;
+	uint64_t decoded;
+} barelog_trace_t;
+
+/**
+ * Position of a reading inside a trace file.
+ * @see host_trace_seek
+ */
+typedef struct {
+	/** Trace being read. */
+	barelog_trace_t *trace;
+	/** Lowest timestamp of the events to read. */
+	uint64_t from;
+	/** Highest timestamp of the events to read. */
+	uint64_t to;
+	/** Mask of the cores whose events to read (bit core % 64), all of
+	 * them by default : it may be restricted after host_trace_seek. */
+	uint64_t cores;
+	/** Chunk being read. */
+	uint32_t chunk;
+	/** Chunk from which no event can be read anymore. */
+	uint32_t end;
+	/** Position of the next record inside the chunk. */
+	uint32_t position;
+} barelog_trace_iter_t;
+
+/**
+ * Opens a trace file by mapping it in memory and loads its index.
+ * @param path the path of the file.
+ * @param trace the structure describing the opened trace.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_trace_open(const char *path, barelog_trace_t *trace) __attribute__ ((cold));
+
+/**
+ * Closes a trace file previously opened with host_trace_open.
+ * @param trace the trace to close.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_trace_close(barelog_trace_t *trace) __attribute__ ((cold));
+
+/**
+ * Positions a reading on the first chunk of a trace which may hold events
+ * logged between two timestamps, using the index only. The chunks without
+ * events of the cores read (see barelog_trace_iter_t) are skipped as well.
+ * @param trace the trace to read.
+ * @param from the lowest timestamp of the events to read.
+ * @param to the highest timestamp of the events to read.
+ * @param iter the reading to position.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_trace_seek(barelog_trace_t *trace, uint64_t from, uint64_t to,
+	barelog_trace_iter_t *iter);
+
+/**
+ * Reads at most max of the next events of a trace logged in the time range
+ * of a reading. The events are returned in the order of the file, i.e. in
+ * the order of their timestamps for each core only. The readings of a
+ * compressed trace share its decoded block : they are not thread-safe.
+ * @param iter the reading (see host_trace_seek).
+ * @param events the buffer (of at least max events) in which to store the events read.
+ * @param max the maximum number of events to read.
+ * @return the number of events read (0 once the range is over), an error code if negative.
+ */
+extern int32_t host_trace_read(barelog_trace_iter_t *iter, barelog_event_t *events, uint32_t max);
+
+#endif /* __BARELOG_HOST_TRACE__ */
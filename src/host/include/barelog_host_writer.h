@@ -0,0 +1,138 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_host_writer.h
+ * @brief Module streaming the events read by the host into trace files.
+ *
+ * The events are pushed by the threads reading them (e.g. the drain threads,
+ * see host_writer_consume) into lock-free queues, one per thread. A background
+ * thread moves them into fixed-size blocks, written at once into segment
+ * files, optionally compressed. The segments are rotated by size or by time, and only the most recent
+ * ones are kept within a disk budget.
+ *
+ * The format of the segment files is described in barelog_host_trace.h : each
+ * segment is closed by writing the index of its blocks.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_HOST_WRITER__
+#define __BARELOG_HOST_WRITER__
+
+#include <stdint.h>
+
+#include "barelog_internal.h"
+#include "barelog_event.h"
+#include "barelog_host_drainer.h"
+#include "barelog_host_trace.h"
+
+/**
+ * Configuration of the writer.
+ */
+typedef struct {
+	/** prefix of the paths of the segment files (<prefix>.<index>.blseg) */
+	const char *prefix;
+	/** size (in bytes) from which a segment is rotated (rounded up
+	 * to a multiple of BARELOG_WRITER_BLOCK_SIZE) */
+	uint64_t segment_size;
+	/** time (in seconds) after which a segment is rotated (0 for none) */
+	uint32_t segment_period;
+	/** size (in bytes) of the kept segments : the oldest segments are removed
+	 * to keep at most budget / segment_size of them (0 to keep all of them) */
+	uint64_t budget;
+	/** number of threads pushing events (one queue each) */
+	uint32_t nb_producers;
+	/** size (in bytes) of each queue (a power of two) */
+	uint32_t queue_size;
+	/** number of timestamp units per second, stored into the segments (0 if unknown) */
+	uint64_t clock_rate;
+	/** if not 0, the segments are written bypassing the page cache (O_DIRECT) */
+	uint8_t direct;
+	/** if not 0, the blocks are compressed (see barelog_host_codec.h) */
+	uint8_t compress;
+} barelog_writer_config_t;
+
+/**
+ * Statistics of the writer.
+ */
+typedef struct {
+	/** Number of events written. */
+	uint64_t events;
+	/** Number of bytes of records written. */
+	uint64_t bytes;
+	/** Number of blocks written. */
+	uint64_t blocks;
+	/** Number of bytes taken by the blocks written (once compressed, if enabled). */
+	uint64_t stored;
+	/** Number of segments opened. */
+	uint32_t segments;
+	/** Number of segments removed to keep within the budget. */
+	uint32_t removed;
+	/** Number of times a producer waited for room in its queue. */
+	uint64_t stalls;
+} barelog_writer_stats_t;
+
+/**
+ * Opens the first segment and starts the writer thread.
+ * @param config the configuration of the writer.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_writer_open(const barelog_writer_config_t *config) __attribute__ ((cold));
+
+/**
+ * Pushes events into the queue of a producer. The producer waits for room
+ * if its queue is full, so that no event is ever dropped.
+ * A queue must only be used by one thread at a time.
+ * @param producer the index of the producer (lower than nb_producers).
+ * @param events the events to push.
+ * @param n the number of events to push.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_writer_push(uint32_t producer, const barelog_event_t *events, uint32_t n);
+
+/**
+ * Consume function of the drain threads (see host_drainer_start) pushing
+ * the events into the queue of the thread. The number of producers of
+ * the writer must be at least the number of drain threads.
+ * @param batch the batch of events to push.
+ * @param arg unused.
+ */
+extern void host_writer_consume(const barelog_drain_batch_t *batch, void *arg);
+
+/**
+ * Writes the events left in the queues, closes the last segment
+ * and stops the writer thread.
+ * @return BARELOG_SUCCESS if all is clear, the first error met otherwise.
+ */
+extern int8_t host_writer_close(void) __attribute__ ((cold));
+
+/**
+ * Returns the statistics of the writer.
+ * @param stats the structure in which to store the statistics.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t host_writer_stats(barelog_writer_stats_t *stats);
+
+#endif /* __BARELOG_HOST_WRITER__ */
@@ -0,0 +1,63 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_linux_sim.h
+ * @brief Module defining the configurations used by barelog when simulating
+ * the target cores on a Linux machine.
+ *
+ * With this configuration (selected by defining BARELOG_LINUX_SIM, e.g. by
+ * building with 'make PLATFORM=linux_sim'), the target library is compiled
+ * natively and each simulated core is a process logging into a shared memory
+ * region (see linux_sim/barelog_sim.h). The local memory of the cores
+ * is the same as on the Parallella platform, but many more cores can be
+ * logged.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_LINUX_SIM__
+#define __BARELOG_LINUX_SIM__
+
+#define BARELOG_NB_CORES 256
+
+/* Maximum size (in bytes) taken in the shared memory by barelog events : */
+#define BARELOG_EVENT_SHARED_MEM_MAX 67108864
+
+/* Maximum string length of the Platform name (deprecated) : */
+#define BARELOG_PLATFORM_NAME_LENGTH 20
+
+/* Maximum size (in bytes) of a barelog_event :*/
+#define BARELOG_EVENT_MAX_SIZE 100
+
+/* Maximum size (in bytes) of each core's local memory reserved for barelog : */
+#define BARELOG_LOCAL_MEM_PER_CORE 1024
+
+/* Debug attribute (TODO : implement mechanism) */
+#define BARELOG_VERBOSE 0
+
+/* Defines whether or not we should apply defensive strategies on code */
+#define BARELOG_CHECK_MODE 1
+
+#endif /* __BARELOG_LINUX_SIM__ */
@@ -42,7 +42,7 @@
 #define BARELOG_NB_CORES 16
 
 /* Maximum size (in bytes) taken in the shared memory by barelog events : */
-#define BARELOG_EVENT_SHARED_MEM_MAX 1000000
+#define BARELOG_EVENT_SHARED_MEM_MAX 1048576
 
 /* Maximum string length of the Platform name (deprecated) : */
 #define BARELOG_PLATFORM_NAME_LENGTH 20
@@ -51,16 +51,17 @@
 #define BARELOG_EVENT_MAX_SIZE 100
 
 /* Maximum size (in bytes) of each core's local memory reserved for barelog : */
-#define BARELOG_LOCAL_MEM_PER_CORE 1000
+#define BARELOG_LOCAL_MEM_PER_CORE 1024
 
 #define BARELOG_LOCAL_MEM_ATTRIBUTE __attribute__ ((section(".data_bank0")))
 
+/* The TESTSET instruction of the Epiphany cores does not reach the external
+ * memory : the cores cannot share a pool of chunks there. */
+#define BARELOG_SHARED_LOCK 0
+
 /* Debug attribute (TODO : implement mechanism) */
 #define BARELOG_VERBOSE 0
 
-/* Memory synchronization (mutexes) between host and device */
-#define BARELOG_SAFE_MODE 0
-
 /* Defines whether or not we should apply defensive strategies on code */
 #define BARELOG_CHECK_MODE 0
 
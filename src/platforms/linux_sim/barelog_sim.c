@@ -0,0 +1,411 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#define _GNU_SOURCE // sched_setaffinity()
+
+#include "barelog_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BARELOG_SIM_TSC 1
+#else
+#define BARELOG_SIM_TSC 0
+#endif
+
+/* Clocks of the calling core (each core being a process). */
+static struct {
+	uint64_t base_ns;
+	uint64_t base_tsc;
+} sim_clock;
+
+/* Fake DMA engine of the calling core : a thread copying the transfers in
+ * the order they were started. The handle of a transfer is its number. */
+static struct {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	struct {
+		void *address;
+		size_t size;
+		const void *buffer;
+	} queue[LINUX_SIM_DMA_QUEUE];
+	uint32_t started;
+	uint32_t completed;
+	uint8_t running;
+} dma = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.changed = PTHREAD_COND_INITIALIZER
+};
+
+/* Cores started by linux_sim_spawn (pid 0 once exited). */
+static struct {
+	pid_t *pids;
+	uint32_t nb_cores;
+	uint32_t running;
+	uint32_t failed;
+} sim;
+
+static inline uint64_t monotonic_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static inline uint64_t tsc(void) {
+#if BARELOG_SIM_TSC
+	return __rdtsc();
+#else
+	return monotonic_ns();
+#endif
+}
+
+static int8_t sim_map(int fd, uint32_t length, barelog_platform_t *platform) {
+	void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED
+		| ((fd < 0) ? MAP_ANONYMOUS : 0), fd, 0);
+
+	if (base == MAP_FAILED) {
+		return BARELOG_ERR;
+	}
+
+	memset(platform, 0, sizeof(barelog_platform_t));
+	strncpy(platform->name, "linux_sim", BARELOG_PLATFORM_NAME_LENGTH - 1);
+	platform->mem_space.phy_base = base;
+	platform->mem_space.base = base;
+	platform->mem_space.length = length;
+	platform->mem_space.alignment = BARELOG_WORD;
+	platform->mem_space.word_size = BARELOG_WORD;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t linux_sim_open(const char *name, uint32_t length,
+		barelog_platform_t *platform) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (platform == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+
+	if (length == 0) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	if (name == NULL) {
+		return sim_map(-1, length, platform);
+	}
+
+	const int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+	if (fd < 0) {
+		return BARELOG_ERR;
+	}
+	int8_t ret = (ftruncate(fd, length) == 0) ? sim_map(fd, length, platform) : BARELOG_ERR;
+	close(fd);
+	if (ret != BARELOG_SUCCESS) {
+		shm_unlink(name);
+	}
+
+	return ret;
+}
+
+int8_t linux_sim_attach(const char *name, barelog_platform_t *platform) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (name == NULL || platform == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	struct stat st;
+	const int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) {
+		return BARELOG_ERR;
+	}
+	int8_t ret = BARELOG_ERR;
+	if (fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size <= UINT32_MAX) {
+		ret = sim_map(fd, st.st_size, platform);
+	}
+	close(fd);
+
+	return ret;
+}
+
+int8_t linux_sim_close(const char *name, barelog_platform_t *platform) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (platform == NULL || platform->mem_space.phy_base == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	int8_t ret = BARELOG_SUCCESS;
+	if (munmap(platform->mem_space.phy_base, platform->mem_space.length)) {
+		ret = BARELOG_ERR;
+	}
+	if (name != NULL && shm_unlink(name)) {
+		ret = BARELOG_ERR;
+	}
+	platform->mem_space.phy_base = NULL;
+	platform->mem_space.base = NULL;
+
+	return ret;
+}
+
+void *linux_sim_mem_init(void *address, size_t size, void *data) {
+	(void) size;
+	(void) data;
+	return address;
+}
+
+int8_t linux_sim_mem_read(const void *address, size_t size, void *buffer) {
+	memcpy(buffer, address, size);
+	return BARELOG_SUCCESS;
+}
+
+int8_t linux_sim_mem_write(void *address, size_t size, const void *buffer) {
+	memcpy(address, buffer, size);
+	return BARELOG_SUCCESS;
+}
+
+int8_t linux_sim_mem_finalize(void *mem_space) {
+	(void) mem_space;
+	return BARELOG_SUCCESS;
+}
+
+static void *dma_engine(void *arg) {
+	(void) arg;
+	pthread_mutex_lock(&dma.lock);
+	for (;;) {
+		while (dma.completed == dma.started) {
+			pthread_cond_wait(&dma.changed, &dma.lock);
+		}
+		const uint32_t i = dma.completed % LINUX_SIM_DMA_QUEUE;
+		pthread_mutex_unlock(&dma.lock);
+
+		linux_sim_mem_write(dma.queue[i].address, dma.queue[i].size, dma.queue[i].buffer);
+
+		pthread_mutex_lock(&dma.lock);
+		++dma.completed;
+		pthread_cond_broadcast(&dma.changed);
+	}
+
+	return NULL;
+}
+
+int8_t linux_sim_dma_write(void *address, size_t size, const void *buffer,
+		uint32_t *handle) {
+
+	pthread_mutex_lock(&dma.lock);
+	/* The engine is started by the first transfer of the core (after the
+	 * fork of its process). */
+	if (!dma.running) {
+		if (pthread_create(&dma.thread, NULL, dma_engine, NULL)) {
+			pthread_mutex_unlock(&dma.lock);
+			return BARELOG_SHRMEM_WRITE_ERR;
+		}
+		pthread_detach(dma.thread);
+		dma.running = 1;
+	}
+	while (dma.started - dma.completed == LINUX_SIM_DMA_QUEUE) {
+		pthread_cond_wait(&dma.changed, &dma.lock);
+	}
+	const uint32_t i = dma.started % LINUX_SIM_DMA_QUEUE;
+	dma.queue[i].address = address;
+	dma.queue[i].size = size;
+	dma.queue[i].buffer = buffer;
+	*handle = ++dma.started;
+	pthread_cond_broadcast(&dma.changed);
+	pthread_mutex_unlock(&dma.lock);
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t linux_sim_dma_poll(uint32_t handle) {
+	pthread_mutex_lock(&dma.lock);
+	const int8_t done = ((int32_t) (dma.completed - handle) >= 0);
+	pthread_mutex_unlock(&dma.lock);
+
+	return done;
+}
+
+int8_t linux_sim_dma_wait(uint32_t handle) {
+	pthread_mutex_lock(&dma.lock);
+	while ((int32_t) (dma.completed - handle) < 0) {
+		pthread_cond_wait(&dma.changed, &dma.lock);
+	}
+	pthread_mutex_unlock(&dma.lock);
+
+	return BARELOG_SUCCESS;
+}
+
+uint32_t linux_sim_clock_ns(void) {
+	return (uint32_t) (monotonic_ns() - sim_clock.base_ns);
+}
+
+uint32_t linux_sim_clock_tsc(void) {
+	return (uint32_t) (tsc() - sim_clock.base_tsc);
+}
+
+int8_t linux_sim_init_clock(void) {
+	sim_clock.base_ns = monotonic_ns();
+	sim_clock.base_tsc = tsc();
+	return BARELOG_SUCCESS;
+}
+
+int8_t linux_sim_start_clock(void) {
+	return BARELOG_SUCCESS;
+}
+
+uint64_t linux_sim_clock_rate(uint32_t (*get_clock)(void)) {
+
+	if (get_clock == linux_sim_clock_ns || (get_clock == linux_sim_clock_tsc && !BARELOG_SIM_TSC)) {
+		return 1000000000;
+	}
+	if (get_clock != linux_sim_clock_tsc) {
+		return 0;
+	}
+
+	const struct timespec period = { .tv_sec = 0, .tv_nsec = 10000000 };
+	const uint64_t start_ns = monotonic_ns();
+	const uint64_t start = tsc();
+	nanosleep(&period, NULL);
+	const uint64_t cycles = tsc() - start;
+	const uint64_t elapsed = monotonic_ns() - start_ns;
+
+	return (elapsed) ? (uint64_t) ((double) cycles * 1e9 / elapsed) : 0;
+}
+
+/* Collects the exit status of a core. */
+static void sim_reap(pid_t pid, int status) {
+	for (uint32_t core = 0; core < sim.nb_cores; ++core) {
+		if (sim.pids[core] == pid) {
+			sim.pids[core] = 0;
+			--sim.running;
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				++sim.failed;
+			}
+			return;
+		}
+	}
+}
+
+int8_t linux_sim_spawn(uint32_t nb_cores, const int32_t *cpus,
+		int (*core_main)(uint32_t core, void *arg), void *arg) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (core_main == NULL) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+
+	if (nb_cores == 0 || nb_cores > BARELOG_NB_CORES) {
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	if (sim.running) {
+		return BARELOG_INIT_ERR;
+	}
+
+	free(sim.pids);
+	sim.pids = calloc(nb_cores, sizeof(pid_t));
+	if (sim.pids == NULL) {
+		return BARELOG_ERR;
+	}
+	sim.nb_cores = nb_cores;
+	sim.failed = 0;
+
+	/* Do not let the cores write again what the host has not printed yet. */
+	fflush(NULL);
+	for (uint32_t core = 0; core < nb_cores; ++core) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			if (cpus != NULL && cpus[core] >= 0) {
+				cpu_set_t set;
+				CPU_ZERO(&set);
+				CPU_SET(cpus[core], &set);
+				sched_setaffinity(0, sizeof(cpu_set_t), &set);
+			}
+			const int ret = core_main(core, arg);
+			fflush(NULL);
+			/* Leave the state of the host (e.g. its destructors) alone. */
+			_exit(ret);
+		}
+		if (pid < 0) {
+			for (uint32_t i = 0; i < core; ++i) {
+				kill(sim.pids[i], SIGKILL);
+			}
+			linux_sim_wait();
+			return BARELOG_INIT_ERR;
+		}
+		sim.pids[core] = pid;
+		++sim.running;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+int32_t linux_sim_running(void) {
+	int status;
+
+	for (uint32_t core = 0; core < sim.nb_cores; ++core) {
+		if (sim.pids[core] > 0) {
+			const pid_t pid = waitpid(sim.pids[core], &status, WNOHANG);
+			if (pid < 0) {
+				return BARELOG_ERR;
+			}
+			if (pid == sim.pids[core]) {
+				sim_reap(pid, status);
+			}
+		}
+	}
+
+	return sim.running;
+}
+
+int32_t linux_sim_wait(void) {
+	int status;
+
+	for (uint32_t core = 0; core < sim.nb_cores; ++core) {
+		if (sim.pids[core] > 0) {
+			if (waitpid(sim.pids[core], &status, 0) != sim.pids[core]) {
+				return BARELOG_ERR;
+			}
+			sim_reap(sim.pids[core], status);
+		}
+	}
+
+	return sim.failed;
+}
@@ -0,0 +1,206 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_sim.h
+ * @brief Module simulating the target cores on a Linux machine.
+ *
+ * The shared memory is a shm_open()/mmap() region (or an anonymous shared
+ * mapping), accessed by memcpy from the host as well as from the cores.
+ * Each simulated core is a process forked from the host program, since the
+ * target modules keep the state of their core in static variables (just as
+ * each core of the Parallella runs its own program). The clocks of the cores
+ * are derived from the clocks of the host (clock_gettime() or the
+ * time-stamp counter of the CPU).
+ *
+ * The whole producer -> shared memory -> host pipeline can thus be run,
+ * benchmarked and profiled on any Linux machine, with many more cores than
+ * the actual platforms (see barelog_linux_sim.h and the barelog-sim tool).
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_SIM__
+#define __BARELOG_SIM__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "barelog_platform.h"
+
+/**
+ * Creates the shared memory region of the simulation and describes it
+ * into a platform.
+ * @param name the name of the POSIX shared memory object (e.g. "/barelog"),
+ * created if needed so that other programs may attach to it (see
+ * linux_sim_attach), or NULL for an anonymous region only shared with the
+ * forked cores.
+ * @param length the size (in bytes) of the region.
+ * @param platform the platform in which to store the region.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t linux_sim_open(const char *name, uint32_t length,
+	barelog_platform_t *platform) __attribute__ ((cold));
+
+/**
+ * Maps an existing shared memory region (created by linux_sim_open) and
+ * describes it into a platform, e.g. to read the cores from another program.
+ * @param name the name of the POSIX shared memory object.
+ * @param platform the platform in which to store the region.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t linux_sim_attach(const char *name,
+	barelog_platform_t *platform) __attribute__ ((cold));
+
+/**
+ * Unmaps the shared memory region of a platform.
+ * @param name the name of the POSIX shared memory object to remove,
+ * NULL to keep it (or for an anonymous region).
+ * @param platform the platform holding the region.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+ */
+extern int8_t linux_sim_close(const char *name,
+	barelog_platform_t *platform) __attribute__ ((cold));
+
+/**
+ * Init function of the shared memory (see host_mem_manager_init) : the
+ * region being mapped by linux_sim_open, its address is used as is.
+ */
+extern void *linux_sim_mem_init(void *address, size_t size, void *data);
+
+/**
+ * Read function of the shared memory (for the host and the cores).
+ */
+extern int8_t linux_sim_mem_read(const void *address, size_t size, void *buffer);
+
+/**
+ * Write function of the shared memory (for the host and the cores).
+ */
+extern int8_t linux_sim_mem_write(void *address, size_t size, const void *buffer);
+
+/**
+ * Finalize function of the shared memory (see host_mem_manager_finalize) :
+ * the region is unmapped by linux_sim_close.
+ */
+extern int8_t linux_sim_mem_finalize(void *mem_space);
+
+/** Number of transfers queued at most by the fake DMA engine of a core. */
+#ifndef LINUX_SIM_DMA_QUEUE
+#define LINUX_SIM_DMA_QUEUE 16
+#endif
+
+/**
+ * Asynchronous write function of the shared memory (see barelog_set_async) :
+ * each core has a fake DMA engine, a thread copying the transfers in the
+ * order they were started. The buffer must remain untouched until the end
+ * of the transfer.
+ * @param address the address to write into the shared memory.
+ * @param size the size (in bytes) of the transfer.
+ * @param buffer the data to write.
+ * @param handle set to the handle of the transfer.
+ * @return BARELOG_SUCCESS if the transfer is started, an error code otherwise.
+ */
+extern int8_t linux_sim_dma_write(void *address, size_t size, const void *buffer,
+	uint32_t *handle);
+
+/**
+ * Poll function of the fake DMA engine (see linux_sim_dma_write).
+ * @param handle the handle of a transfer.
+ * @return 1 if the transfer is over, 0 otherwise.
+ */
+extern int8_t linux_sim_dma_poll(uint32_t handle);
+
+/**
+ * Wait function of the fake DMA engine (see linux_sim_dma_write).
+ * @param handle the handle of a transfer.
+ * @return BARELOG_SUCCESS once the transfer is over.
+ */
+extern int8_t linux_sim_dma_wait(uint32_t handle);
+
+/**
+ * Clock of a core counting nanoseconds (CLOCK_MONOTONIC) since the last
+ * call of linux_sim_init_clock. It wraps every 4.29 seconds.
+ * @return the current timestamp on 32 bits.
+ */
+extern uint32_t linux_sim_clock_ns(void);
+
+/**
+ * Clock of a core counting the cycles of the time-stamp counter of the CPU
+ * since the last call of linux_sim_init_clock (on x86 only, falling back
+ * on linux_sim_clock_ns otherwise).
+ * @return the current timestamp on 32 bits.
+ */
+extern uint32_t linux_sim_clock_tsc(void);
+
+/**
+ * Resets the clocks of the calling core.
+ * @return BARELOG_SUCCESS.
+ */
+extern int8_t linux_sim_init_clock(void);
+
+/**
+ * Starts the clocks of the calling core (they are always running).
+ * @return BARELOG_SUCCESS.
+ */
+extern int8_t linux_sim_start_clock(void);
+
+/**
+ * Returns the number of timestamp units per second of a clock.
+ * The rate of the time-stamp counter is measured against CLOCK_MONOTONIC
+ * (which takes about 10 milliseconds).
+ * @param get_clock the clock (linux_sim_clock_ns or linux_sim_clock_tsc).
+ * @return the rate of the clock, 0 if unknown.
+ */
+extern uint64_t linux_sim_clock_rate(uint32_t (*get_clock)(void)) __attribute__ ((cold));
+
+/**
+ * Starts the simulated cores : a process is forked for each core, which
+ * calls core_main and exits with its return value. The host program should
+ * thus initialize the host memory manager first, and the cores must only
+ * call the target modules (they should start with barelog_init_logger).
+ * @param nb_cores the number of cores to start.
+ * @param cpus (optional) the CPU on which to pin each core (a negative
+ * value leaves the core unpinned), NULL to pin none of them.
+ * @param core_main the function run by each core.
+ * @param arg the parameter given to core_main.
+ * @return BARELOG_SUCCESS if all is clear, an error code otherwise (the
+ * cores already started are then killed).
+ */
+extern int8_t linux_sim_spawn(uint32_t nb_cores, const int32_t *cpus,
+	int (*core_main)(uint32_t core, void *arg), void *arg) __attribute__ ((cold));
+
+/**
+ * Collects the simulated cores which have exited, without blocking.
+ * @return the number of cores still running, or an error code.
+ */
+extern int32_t linux_sim_running(void);
+
+/**
+ * Waits for all the simulated cores to exit.
+ * @return the number of cores which failed (exiting with a value other
+ * than 0, or killed), or an error code.
+ */
+extern int32_t linux_sim_wait(void) __attribute__ ((cold));
+
+#endif /* __BARELOG_SIM__ */
@@ -0,0 +1,256 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+#include "barelog_bench.h"
+
+/* Occupancies (in percents) of the shared memory measured. */
+static const uint32_t occupancies[BARELOG_BENCH_NB_OCCUPANCIES] = { 0, 50, 100 };
+
+static struct {
+	const barelog_bench_config_t *config;
+	/* Costs of reading the counters around an empty call. */
+	uint32_t clock_overhead;
+	uint32_t instructions_overhead;
+	/* Events stored by device_mem_manager_write_buffer(). */
+	barelog_event_t event;
+	barelog_event_t filler;
+} bench;
+
+/* Reads the counters around a call and accounts for its cost. */
+#define BARELOG_BENCH_CALL(result, call) do { \
+	const uint32_t instructions = (bench.config->get_instructions) ? \
+		bench.config->get_instructions() : 0; \
+	const uint32_t start = bench.config->get_clock(); \
+	const int8_t called = (call); \
+	const uint32_t end = bench.config->get_clock(); \
+	const uint32_t executed = (bench.config->get_instructions) ? \
+		bench.config->get_instructions() - instructions : 0; \
+	bench_account(result, end - start, executed, called); \
+} while (0)
+
+static inline void bench_account(barelog_bench_result_t *result, uint32_t cycles,
+	uint32_t instructions, int8_t ret) {
+	cycles = (cycles > bench.clock_overhead) ? cycles - bench.clock_overhead : 0;
+	instructions = (instructions > bench.instructions_overhead) ?
+		instructions - bench.instructions_overhead : 0;
+	if (!result->calls || cycles < result->min) {
+		result->min = cycles;
+	}
+	if (cycles > result->max) {
+		result->max = cycles;
+	}
+	result->cycles += cycles;
+	result->instructions += instructions;
+	++result->calls;
+	if (ret < 0) {
+		++result->errors;
+	}
+}
+
+/* Measures the cost of reading the counters (the cheapest of many readings). */
+static void bench_calibrate(void) {
+	barelog_bench_result_t result;
+
+	memset(&result, 0, sizeof(result));
+	bench.clock_overhead = 0;
+	bench.instructions_overhead = 0;
+	uint32_t instructions = UINT32_MAX;
+	for (uint32_t i = 0; i < 256; ++i) {
+		const uint64_t before = result.instructions;
+		BARELOG_BENCH_CALL(&result, BARELOG_SUCCESS);
+		if (result.instructions - before < instructions) {
+			instructions = result.instructions - before;
+		}
+	}
+	bench.clock_overhead = result.min;
+	bench.instructions_overhead = instructions;
+}
+
+/* Brings the occupancy of the shared memory close to the given one (within
+ * the size of the local buffer), by flushing filler events. The events of
+ * the local buffer are discarded. */
+static int8_t bench_fill(uint32_t occupancy) {
+	uint32_t used, size;
+	int8_t ret = device_mem_manager_occupancy(&used, &size);
+
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+	const uint32_t target = (uint32_t) ((uint64_t) size * occupancy / 100);
+	if (used + BARELOG_LOCAL_BUFFER_SIZE >= target && used <= target + BARELOG_LOCAL_BUFFER_SIZE) {
+		return BARELOG_SUCCESS;
+	}
+
+	device_mem_manager_clean_buffer();
+	if (used > target) {
+		ret = device_mem_manager_clean_memory();
+		if (ret != BARELOG_SUCCESS) {
+			return ret;
+		}
+		used = 0;
+	}
+
+	/* By whole local buffers, then record by record. */
+	const uint32_t record_size = BARELOG_RECORD_SIZE(bench.filler.length);
+	uint32_t batch = BARELOG_LOCAL_BUFFER_SIZE / record_size - 1;
+	while (used + record_size <= target) {
+		const uint32_t before = used;
+		if (used + BARELOG_LOCAL_BUFFER_SIZE > target) {
+			batch = 1;
+		}
+		for (uint32_t i = 0; i < batch && !device_mem_manager_is_buffer_full(); ++i) {
+			bench.filler.timestamp = bench.config->get_clock();
+			device_mem_manager_write_buffer(&bench.filler, bench.filler.length);
+		}
+		device_mem_manager_flush_buffer();
+		device_mem_manager_clean_buffer();
+		ret = device_mem_manager_occupancy(&used, &size);
+		if (ret != BARELOG_SUCCESS) {
+			return ret;
+		}
+		/* The memory policy does not let the records in anymore. */
+		if (used <= before) {
+			break;
+		}
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+static inline int8_t bench_log(barelog_bench_pattern_t pattern, uint32_t i) {
+	switch (pattern) {
+	case BARELOG_BENCH_NO_ARGS:
+		return barelog_log(BARELOG_CRITICAL_LVL, "benchmark event without any argument");
+	case BARELOG_BENCH_INTS:
+		return barelog_log(BARELOG_CRITICAL_LVL, "ints %d %u %x %d", (int) i, i, i * 2654435761u, -42);
+	case BARELOG_BENCH_STRINGS:
+		return barelog_log(BARELOG_CRITICAL_LVL, "strings %s %s", "first", "second string");
+	default:
+		return barelog_log(BARELOG_CRITICAL_LVL, "mixed %s %d %x %c", "name", (int) i, i, 'c');
+	}
+}
+
+/* Stores some events into the local buffer, before flushing or cleaning them. */
+static void bench_prepare(void) {
+	device_mem_manager_clean_buffer();
+	for (uint32_t i = 0; i < BARELOG_BENCH_BATCH; ++i) {
+		bench.event.timestamp = bench.config->get_clock();
+		device_mem_manager_write_buffer(&bench.event, bench.event.length);
+	}
+}
+
+/* Measures a function in a given configuration. */
+static int8_t bench_measure(barelog_bench_result_t *result) {
+	const barelog_bench_config_t *config = bench.config;
+	int8_t ret = device_mem_manager_set_buffer_policy(result->buffer_policy, NULL);
+
+	if (ret == BARELOG_SUCCESS) {
+		device_mem_manager_clean_buffer();
+		ret = device_mem_manager_clean_memory();
+	}
+	for (uint32_t i = 0; i < config->iterations && ret == BARELOG_SUCCESS; ++i) {
+		ret = bench_fill(result->occupancy);
+		if (ret != BARELOG_SUCCESS) {
+			break;
+		}
+		switch (result->api) {
+		case BARELOG_BENCH_LOG:
+			BARELOG_BENCH_CALL(result, bench_log(result->pattern, i));
+			break;
+		case BARELOG_BENCH_WRITE_BUFFER:
+			bench.event.timestamp = config->get_clock();
+			BARELOG_BENCH_CALL(result, device_mem_manager_write_buffer(&bench.event,
+				bench.event.length));
+			break;
+		case BARELOG_BENCH_FLUSH:
+			bench_prepare();
+			BARELOG_BENCH_CALL(result, device_mem_manager_flush(BARELOG_BENCH_BATCH));
+			device_mem_manager_clean_buffer();
+			break;
+		default:
+			bench_prepare();
+			BARELOG_BENCH_CALL(result, device_mem_manager_clean(BARELOG_BENCH_BATCH));
+			break;
+		}
+	}
+
+	return ret;
+}
+
+int32_t barelog_bench_run(const barelog_bench_config_t *config,
+		barelog_bench_result_t *results, uint32_t max) {
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!config || !config->get_clock || !results) {
+		return BARELOG_UNINITIALIZED_PARAM_ERR;
+	}
+#endif
+
+	barelog_policy_t buffer_policy;
+	int8_t ret = device_mem_manager_set_buffer_policy(FLUSH, &buffer_policy);
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+
+	bench.config = config;
+	bench_calibrate();
+	memset(&(bench.event), 0, sizeof(barelog_event_t));
+	strcpy(bench.event.data, "write_buffer benchmark event");
+	bench.event.length = strlen(bench.event.data) + 1;
+	bench.event.level = BARELOG_CRITICAL_LVL;
+	bench.filler = bench.event;
+	memset(bench.filler.data, 'f', BARELOG_BUF_MAX_SIZE - 1);
+	bench.filler.data[BARELOG_BUF_MAX_SIZE - 1] = '\0';
+	bench.filler.length = BARELOG_BUF_MAX_SIZE;
+
+	uint32_t n = 0;
+	for (uint32_t api = 0; api < BARELOG_BENCH_NB_APIS; ++api) {
+		const uint32_t nb_patterns = (api == BARELOG_BENCH_LOG) ? BARELOG_BENCH_NB_PATTERNS : 1;
+		/* Flushing and cleaning do not depend on the buffer policy, and
+		 * cleaning neither on the shared memory. */
+		const uint32_t last_policy = (api <= BARELOG_BENCH_WRITE_BUFFER) ? DESTROY : FLUSH;
+		const uint32_t nb_occupancies = (api == BARELOG_BENCH_CLEAN) ? 1 : BARELOG_BENCH_NB_OCCUPANCIES;
+		for (uint32_t pattern = 0; pattern < nb_patterns; ++pattern) {
+			for (uint32_t policy = (last_policy == FLUSH) ? FLUSH : SKIP; policy <= last_policy; ++policy) {
+				for (uint32_t i = 0; i < nb_occupancies && n < max && ret == BARELOG_SUCCESS; ++i) {
+					barelog_bench_result_t *result = &(results[n++]);
+					memset(result, 0, sizeof(barelog_bench_result_t));
+					result->api = api;
+					result->pattern = pattern;
+					result->buffer_policy = policy;
+					result->occupancy = occupancies[i];
+					ret = bench_measure(result);
+				}
+			}
+		}
+	}
+
+	device_mem_manager_clean_buffer();
+	const int8_t cleaned = device_mem_manager_clean_memory();
+	device_mem_manager_set_buffer_policy(buffer_policy, NULL);
+	if (ret == BARELOG_SUCCESS) {
+		ret = cleaned;
+	}
+
+	return (ret == BARELOG_SUCCESS) ? (int32_t) n : ret;
+}
@@ -25,6 +25,8 @@
 
 #include "barelog_internal.h"
 
+#include <stddef.h>
+
 #if BARELOG_DEBUG_MODE
 #include <stdio.h>
 #include <string.h>
@@ -41,63 +43,434 @@
 
 static barelog_device_mem_manager_t manager BARELOG_LOCAL_MEM_ATTRIBUTE;
 
-/* Host/Device synchronization functions */
-#if BARELOG_SAFE_MODE
-static void* mutex_byte_address BARELOG_LOCAL_MEM_ATTRIBUTE;
-
-#define barelog_get_mutex(mutex) do { \
-	if (manager.read(mutex_byte_address, 1, &(mutex)) != BARELOG_SUCCESS) { \
-		return BARELOG_SHRMEM_READ_ERR; \
-	} \
-}while(0)
-
-#define barelog_set_mutex(value) do { \
-	uint8_t __set_mutex_tmp = (value); \
-	if (manager.write(mutex_byte_address, 1, &__set_mutex_tmp) != BARELOG_SUCCESS) { \
-		return BARELOG_SHRMEM_WRITE_ERR; \
-	} \
-} while(0)
-
-#define barelog_try_mutex() do { \
-uint8_t __mutex = 1; \
-uint32_t __timeout = BARELOG_MUTEX_TRY_MAX; \
-while (__mutex) { \
-	--__timeout; \
-	barelog_get_mutex(__mutex); \
-	if (__timeout <= 0) { \
-		return BARELOG_TIMEOUT_ERR; \
-	} \
-} \
-} while (0)
-#else
-
-#define barelog_get_mutex(mutex)
-#define barelog_set_mutex(value)
-#define barelog_try_mutex()
-
-#endif // BARELOG_SAFE_MODE
-
 #if BARELOG_DEBUG_MODE
 
 void barelog_debug_log(char *file, int line, int8_t errcode,
 	const char *message) {
 	barelog_event_t event;
+	/* The shared memory may have no debug section (see barelog_shared_header_t). */
+	if (manager.debug_address == NULL) {
+		return;
+	}
 	snprintf(event.data, BARELOG_BUF_MAX_SIZE, "%s:%d:%i: %s", file, line, errcode, message);
 	memcpy(manager.debug_address, &event, sizeof(barelog_event_t));
 }
 
 #endif // BARELOG_DEBUG_MODE
 
-static inline uint32_t mod(int32_t a, int32_t b) {
-	const int32_t tmp = (a) % (b);
+/* Header of the records indicating that the following records are stored
+ * at the beginning of a buffer. */
+static const barelog_record_header_t skip_record = { 0, 0, BARELOG_RECORD_SKIP, 0 };
+
+/* Returned by shared_room() when the records have to be skipped. */
+#define BARELOG_SHARED_SKIPPED 1
+
+/* Returns the counter of the oldest byte of the shared ring still in use
+ * (neither consumed by the host nor overwritten). */
+static inline uint32_t shared_oldest(void) {
+	return ((int32_t) (manager.shr_events.tail - manager.shr_events.oldest) > 0) ?
+		manager.shr_events.tail : manager.shr_events.oldest;
+}
+
+/* Returns the address in shared memory of the byte of the ring at the given
+ * counter, looking up the chunk of its segment if a pool is used (NULL if the
+ * chunk was given back to the pool). */
+static inline uint8_t *shared_record(uint32_t counter) {
+	if (!manager.shr_events.chain) {
+		return &(manager.shr_events.records[counter & manager.shr_events.mask]);
+	}
+
+	const uint32_t segment = counter & ~(manager.shr_events.segment_size - 1);
+	if (segment != manager.shr_events.segment) {
+		barelog_chunk_link_t link;
+		manager.read(&(manager.shr_events.chain[(segment >> manager.shr_events.chain_shift)
+			& manager.shr_events.chain_mask]), sizeof(barelog_chunk_link_t), &link);
+		if (link.segment != segment || link.chunk == BARELOG_CHUNK_NONE) {
+			return NULL;
+		}
+		manager.shr_events.segment = segment;
+		manager.shr_events.chunk = manager.shr_events.chunks
+			+ link.chunk * manager.shr_events.segment_size;
+	}
+
+	return manager.shr_events.chunk + (counter - segment);
+}
+
+/* Returns the padding (in bytes) to skip before storing a record of the given
+ * size at the given counter of the shared ring, writing a BARELOG_RECORD_SKIP
+ * record if needed. */
+static inline uint32_t shared_padding(uint32_t counter, uint32_t size, uint8_t mark) {
+	const uint32_t position = counter & (manager.shr_events.segment_size - 1);
+
+	if (position + size <= manager.shr_events.segment_size) {
+		return 0;
+	}
+	if (mark && position + BARELOG_RECORD_HEADER_SIZE <= manager.shr_events.segment_size) {
+		manager.write(shared_record(counter),
+			BARELOG_RECORD_HEADER_SIZE, (const void *) &skip_record);
+	}
+
+	return manager.shr_events.segment_size - position;
+}
+
+/* Returns the room (in bytes) taken in the shared ring from the oldest counter
+ * to the end one, by whole segments if a pool is used (so that each chunk in
+ * use has its own link in the chain). */
+static inline uint32_t shared_span(uint32_t oldest, uint32_t end) {
+	if (!manager.shr_events.chain) {
+		return end - oldest;
+	}
+
+	const uint32_t mask = manager.shr_events.segment_size - 1;
+	if ((int32_t) (manager.shr_events.mapped - end) > 0) {
+		end = manager.shr_events.mapped;
+	}
+	return ((end + mask) & ~mask) - (oldest & ~mask);
+}
+
+/* Writes a control word of the shared ring. */
+static inline int8_t shared_control(uint32_t *word, uint32_t value) {
+	if (manager.write(word, sizeof(uint32_t), (const void *) &value) != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_SHRMEM_WRITE_ERR,
+			"shared memory writing error");
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+
+	return BARELOG_SUCCESS;
+}
+
+/* Publishes the records written into the shared ring to the host. */
+static inline int8_t shared_publish(void) {
+	barelog_memory_barrier();
+	return shared_control(&(manager.shr_events.ring->head), manager.shr_events.head);
+}
+
+/* Accounts for an update of the statistics, publishing them periodically. */
+static inline int8_t stats_changed(void) {
+	if (++manager.stats_changes < BARELOG_STATS_PERIOD) {
+		return BARELOG_SUCCESS;
+	}
+	return device_mem_manager_publish_stats();
+}
+
+/* Moves a counter of the shared ring beyond the record stored at its
+ * position. Returns 1 if an actual record was passed, 0 if it was the end
+ * of a segment (see BARELOG_RECORD_SKIP) or a segment already consumed by
+ * the host, an error code otherwise. */
+static int8_t shared_next(uint32_t *counter) {
+	const uint32_t position = *counter & (manager.shr_events.segment_size - 1);
+	barelog_record_header_t header;
+
+	if (position + BARELOG_RECORD_HEADER_SIZE > manager.shr_events.segment_size) {
+		*counter += manager.shr_events.segment_size - position;
+		return 0;
+	}
+	/* The records before the tail read by the core may be consumed by the
+	 * host meanwhile, and their chunk reused : the link is checked before
+	 * and after reading the header. */
+	manager.shr_events.segment = BARELOG_CHUNK_NONE;
+	const uint8_t *record = shared_record(*counter);
+	if (record && manager.read(record,
+		BARELOG_RECORD_HEADER_SIZE, &header) != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_SHRMEM_READ_ERR,
+			"shared memory reading error");
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	if (manager.shr_events.chain) {
+		barelog_memory_barrier();
+		manager.shr_events.segment = BARELOG_CHUNK_NONE;
+		if (!record || shared_record(*counter) != record) {
+			*counter += manager.shr_events.segment_size - position;
+			return 0;
+		}
+	}
+	if (header.length == BARELOG_RECORD_SKIP) {
+		*counter += manager.shr_events.segment_size - position;
+		return 0;
+	}
+	*counter += BARELOG_RECORD_SIZE(header.length);
+
+	return 1;
+}
+
+/* Takes the lock of the pool of chunks, giving up after BARELOG_POOL_LOCK_SPIN
+ * attempts. */
+static inline int8_t pool_lock(void) {
+	uint32_t spin = 0;
+
+	while (barelog_test_and_set(&(manager.shr_events.pool->lock))) {
+		if (++spin >= BARELOG_POOL_LOCK_SPIN) {
+			BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_TIMEOUT_ERR,
+				"pool of chunks locked");
+			return BARELOG_TIMEOUT_ERR;
+		}
+	}
+	barelog_memory_barrier();
+
+	return BARELOG_SUCCESS;
+}
+
+/* Releases the lock of the pool of chunks, returning ret. */
+static inline int8_t pool_unlock(int8_t ret) {
+	const uint32_t unlocked = 0;
+
+	barelog_memory_barrier();
+	if (manager.write(&(manager.shr_events.pool->lock), sizeof(uint32_t), &unlocked) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+
+	return ret;
+}
+
+/* Maps a chunk of the pool to each segment of the shared ring up to the end
+ * counter. Returns BARELOG_SHARED_SKIPPED if the pool is exhausted, and
+ * BARELOG_TIMEOUT_ERR if its lock cannot be taken. */
+static int8_t shared_map(uint32_t end) {
+	barelog_shared_mem_buffer_t *shared = &(manager.shr_events);
+	uint32_t *stack = (uint32_t *) (shared->pool + 1);
+	barelog_chunk_link_t link;
+	uint32_t count = 0;
+	int8_t ret = BARELOG_SUCCESS;
+
+	if (!shared->chain || (int32_t) (end - shared->mapped) <= 0) {
+		return BARELOG_SUCCESS;
+	}
 
-	uint32_t result =
-		(tmp >= 0) ? ((uint32_t) tmp) : ((uint32_t) (tmp + b));
+	ret = pool_lock();
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+	if (manager.read(&(shared->pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		return pool_unlock(BARELOG_SHRMEM_READ_ERR);
+	}
+	while ((int32_t) (end - shared->mapped) > 0) {
+		barelog_chunk_link_t *slot = &(shared->chain[(shared->mapped >> shared->chain_shift)
+			& shared->chain_mask]);
+		if (manager.read(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_READ_ERR;
+			break;
+		}
+		/* The chunk of a segment consumed but not given back yet is reused. */
+		if (link.chunk == BARELOG_CHUNK_NONE) {
+			if (!count) {
+				ret = BARELOG_SHARED_SKIPPED;
+				break;
+			}
+			if (manager.read(&(stack[--count]), sizeof(uint32_t), &(link.chunk)) != BARELOG_SUCCESS) {
+				ret = BARELOG_SHRMEM_READ_ERR;
+				break;
+			}
+		}
+		link.segment = shared->mapped;
+		if (manager.write(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_WRITE_ERR;
+			break;
+		}
+		shared->mapped += shared->segment_size;
+	}
+	if (manager.write(&(shared->pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_WRITE_ERR;
+	}
 
-	return result;
+	return pool_unlock(ret);
 }
 
-int8_t device_mem_manager_init(const uint32_t my_core,
+/* Gives back to the pool the chunks of the segments of the shared ring lying
+ * between the from and end counters (all the chunks of the chain if from and
+ * end are equal), unless the host already did. Returns BARELOG_TIMEOUT_ERR
+ * if the lock of the pool cannot be taken. */
+static int8_t shared_release(uint32_t from, uint32_t end) {
+	barelog_shared_mem_buffer_t *shared = &(manager.shr_events);
+	uint32_t *stack = (uint32_t *) (shared->pool + 1);
+	barelog_chunk_link_t link;
+	uint32_t count = 0;
+	int8_t ret = BARELOG_SUCCESS;
+
+	if (!shared->chain) {
+		return BARELOG_SUCCESS;
+	}
+	uint32_t segment = from & ~(shared->segment_size - 1);
+	if (from == end || end - segment > shared->size) {
+		segment = (end - shared->size) & ~(shared->segment_size - 1);
+	}
+
+	ret = pool_lock();
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+	if (manager.read(&(shared->pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		return pool_unlock(BARELOG_SHRMEM_READ_ERR);
+	}
+	for (; end - segment >= shared->segment_size; segment += shared->segment_size) {
+		barelog_chunk_link_t *slot = &(shared->chain[(segment >> shared->chain_shift)
+			& shared->chain_mask]);
+		if (manager.read(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_READ_ERR;
+			break;
+		}
+		if (link.chunk == BARELOG_CHUNK_NONE || (from != end && link.segment != segment)) {
+			continue;
+		}
+		if (manager.write(&(stack[count++]), sizeof(uint32_t), &(link.chunk)) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_WRITE_ERR;
+			break;
+		}
+		link.chunk = BARELOG_CHUNK_NONE;
+		if (manager.write(slot, sizeof(barelog_chunk_link_t), &link) != BARELOG_SUCCESS) {
+			ret = BARELOG_SHRMEM_WRITE_ERR;
+			break;
+		}
+	}
+	if (manager.write(&(shared->pool->count), sizeof(uint32_t), &count) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_WRITE_ERR;
+	}
+	shared->segment = BARELOG_CHUNK_NONE;
+
+	return pool_unlock(ret);
+}
+
+/* Applies the memory policy to make room for the records ending at the end
+ * counter of the shared ring, either because they do not fit into the ring
+ * or because the pool of chunks is exhausted. Returns BARELOG_SHARED_SKIPPED
+ * if the records have to be skipped. */
+static int8_t shared_reclaim(uint32_t end) {
+	int8_t ret = 0;
+
+	/* The pool is exhausted : the host may have consumed some records since
+	 * the last reading (which are then not overwritten). */
+	if (shared_span(shared_oldest(), end) <= manager.shr_events.size
+		&& manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_READ_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"shared memory reading error");
+		return ret;
+	}
+
+	uint32_t oldest = shared_oldest();
+	const uint32_t from = oldest;
+	/* If the records fit into the ring, a whole chunk has to be given back. */
+	const uint32_t limit = (shared_span(oldest, end) > manager.shr_events.size) ? oldest
+		: (oldest | (manager.shr_events.segment_size - 1)) + 1;
+
+	if ((int32_t) (limit - manager.shr_events.head) > 0) {
+		/* The only chunk in use is the one being written. */
+		return BARELOG_SHARED_SKIPPED;
+	}
+
+	switch (manager.memory_policy) {
+	case SKIP:
+		return BARELOG_SHARED_SKIPPED;
+		break;
+	case REPLACE:
+		/* Moves the oldest counter beyond the records to overwrite. */
+		while (shared_span(oldest, end) > manager.shr_events.size
+			|| (int32_t) (limit - oldest) > 0) {
+			ret = shared_next(&oldest);
+			if (ret < 0) {
+				return ret;
+			}
+			manager.stats.overwritten += ret;
+		}
+		manager.shr_events.oldest = oldest;
+		ret = shared_control(&(manager.shr_events.ring->oldest), oldest);
+		barelog_memory_barrier();
+		if (ret == BARELOG_SUCCESS) {
+			ret = shared_release(from, oldest);
+		}
+		return (ret == BARELOG_SUCCESS) ? stats_changed() : ret;
+		break;
+	case DESTROY:
+		return device_mem_manager_clean_memory();
+		break;
+	default:
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_ERR, "unrecognized policy");
+		return BARELOG_ERR;
+	}
+}
+
+/* Makes room for size bytes at the head of the shared ring (mapping the
+ * chunks needed if a pool is used), applying the memory policy if needed.
+ * Returns BARELOG_SHARED_SKIPPED if the records have to be skipped. */
+static int8_t shared_room(uint32_t size) {
+	int8_t ret = 0;
+	const uint32_t end = manager.shr_events.head + size;
+
+	if (size > manager.shr_events.size) {
+		ret = BARELOG_INCONSISTENT_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"shared memory buffer too small");
+		return ret;
+	}
+
+	/* The host may have consumed some records since the last reading. */
+	if (shared_span(shared_oldest(), end) > manager.shr_events.size
+		&& manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_READ_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"shared memory reading error");
+		return ret;
+	}
+
+	while (shared_span(shared_oldest(), end) > manager.shr_events.size
+		|| (ret = shared_map(end)) == BARELOG_SHARED_SKIPPED) {
+		ret = shared_reclaim(end);
+		if (ret != BARELOG_SUCCESS) {
+			return ret;
+		}
+	}
+
+	return ret;
+}
+
+#if !BARELOG_WRITE_THROUGH_MODE
+
+/* Returns the header of the record stored at the position of a given
+ * counter inside the local buffer, following the BARELOG_RECORD_SKIP records
+ * (and the too small spaces at the end of the buffer) if needed. */
+static inline barelog_record_header_t *local_record(uint32_t *counter) {
+	const uint32_t position = *counter & BARELOG_LOCAL_BUFFER_MASK;
+
+	if (position + BARELOG_RECORD_HEADER_SIZE > BARELOG_LOCAL_BUFFER_SIZE
+		|| ((barelog_record_header_t *) &(manager.events.buffer[position]))->length == BARELOG_RECORD_SKIP) {
+		*counter += BARELOG_LOCAL_BUFFER_SIZE - position;
+		return (barelog_record_header_t *) &(manager.events.buffer[0]);
+	}
+
+	return (barelog_record_header_t *) &(manager.events.buffer[position]);
+}
+
+/* Returns the counter of the oldest byte of the local buffer still in use,
+ * either by a record or by a pending asynchronous transfer. */
+static inline uint32_t local_tail(void) {
+	return manager.nb_transfers ? manager.transfer_tail : manager.events.tail;
+}
+
+/* Returns the padding (in bytes) to skip before storing a record of the given
+ * size inside the local buffer, or BARELOG_LOCAL_BUFFER_SIZE if it does not fit. */
+static inline uint32_t local_room(uint32_t size) {
+	const uint32_t position = manager.events.head & BARELOG_LOCAL_BUFFER_MASK;
+	const uint32_t padding = (position + size > BARELOG_LOCAL_BUFFER_SIZE) ?
+		BARELOG_LOCAL_BUFFER_SIZE - position : 0;
+
+	return (manager.events.head - local_tail() + padding + size <= BARELOG_LOCAL_BUFFER_SIZE) ?
+		padding : BARELOG_LOCAL_BUFFER_SIZE;
+}
+
+/* Writes into the shared memory, asynchronously if possible (the written
+ * buffer must then remain untouched until the end of the transfer). */
+static inline int8_t shared_write(void *address, size_t size, const void *buffer) {
+	if (!manager.write_async) {
+		return manager.write(address, size, buffer);
+	}
+	return manager.write_async(address, size, buffer,
+		&(manager.transfers[manager.nb_transfers++]));
+}
+
+#endif // !BARELOG_WRITE_THROUGH_MODE
+
+int32_t device_mem_manager_init(const uint32_t my_core,
 	const barelog_platform_t platform, const barelog_policy_t buffer_policy,
 	const barelog_policy_t memory_policy,
 	int8_t (*read)(const void * address, size_t size, void *buffer),
@@ -113,66 +486,414 @@ int8_t device_mem_manager_init(const uint32_t my_core,
 	}
 #endif
 
-#if BARELOG_DEBUG_MODE
-	manager.debug_address = platform.mem_space.phy_base + BARELOG_DEBUG_OFF;
-#endif
-
 	manager.core = my_core;
 	manager.read = read;
 	manager.write = write;
 	manager.buffer_policy = buffer_policy;
 	manager.memory_policy = memory_policy;
 
-	void *base = platform.mem_space.phy_base
-		+ BARELOG_SHARED_MEM_DATA_OFFSET;
-	manager.mem_space.phy_base = base + manager.core * BARELOG_SHARED_MEM_PER_CORE_MAX;
-	manager.mem_space.length = BARELOG_SHARED_MEM_PER_CORE_MAX;
+	/* The layout of the shared memory is described by the host. */
+	barelog_shared_header_t header;
+	void *shared = platform.mem_space.phy_base;
+	if (manager.read(shared, BARELOG_SHARED_HEADER_SIZE, &header) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	if (memcmp(header.magic, BARELOG_SHARED_MAGIC, sizeof(BARELOG_SHARED_MAGIC))
+		|| header.version != BARELOG_SHARED_VERSION
+		|| header.record_version != BARELOG_RECORD_VERSION
+		|| manager.core >= header.nb_cores
+		|| header.event_max_size < BARELOG_EVENT_MAX_SIZE
+		|| header.ring_size & (header.ring_size - 1)
+		|| header.ring_size < BARELOG_SEGMENT_MIN_SIZE) {
+		return BARELOG_INIT_ERR;
+	}
+	/* A flush must not span more than two chunks (see BARELOG_TRANSFERS_MAX). */
+	if (header.chunk_size && (!BARELOG_SHARED_LOCK || header.chunk_size & (header.chunk_size - 1)
+		|| header.chunk_size < BARELOG_SEGMENT_MIN_SIZE
+		|| header.chunk_size > header.ring_size)) {
+		return BARELOG_INIT_ERR;
+	}
+
+#if BARELOG_DEBUG_MODE
+	manager.debug_address = (header.debug_size >= BARELOG_DEBUG_MEM_SIZE) ?
+		shared + header.debug_offset : NULL;
+#endif
+
+	void *base = shared + header.data_offset;
+	manager.mem_space.phy_base = base + manager.core * header.core_size;
+	manager.mem_space.length = (header.chunk_size) ?
+		header.nb_chunks * header.chunk_size : header.core_size;
 	manager.mem_space.alignment = platform.mem_space.alignment;
 	manager.mem_space.word_size = platform.mem_space.word_size;
 	manager.mem_space.data = 0;
 	manager.mem_space.base = manager.mem_space.phy_base;
 
-	manager.shr_events.events = (barelog_event_t *) (manager.mem_space.phy_base);
-	manager.shr_events.imax = BARELOG_SHARED_MEM_PER_CORE_MAX
-		/ sizeof(barelog_event_t);
-	manager.shr_events.index = 0;
+	/* The records are written after the ones already consumed by the host. */
+	manager.shr_events.ring = (barelog_shared_ring_t *) (shared + header.ring_offset) + manager.core;
+	manager.shr_events.records = (uint8_t *) (manager.mem_space.phy_base);
+	manager.shr_events.size = header.ring_size;
+	manager.shr_events.mask = header.ring_size - 1;
+	manager.shr_events.segment_size = header.ring_size;
+	manager.shr_events.chain = NULL;
+	if (header.chunk_size) {
+		manager.shr_events.segment_size = header.chunk_size;
+		manager.shr_events.chain_mask = header.ring_size / header.chunk_size - 1;
+		manager.shr_events.chain_shift = __builtin_ctz(header.chunk_size);
+		manager.shr_events.chain = (barelog_chunk_link_t *) (shared + header.chain_offset)
+			+ manager.core * (manager.shr_events.chain_mask + 1);
+		manager.shr_events.pool = (barelog_chunk_pool_t *) (shared + header.pool_offset);
+		manager.shr_events.chunks = base;
+	}
+	if (manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	manager.shr_events.head = manager.shr_events.tail;
+	manager.shr_events.oldest = manager.shr_events.tail;
+	if (shared_control(&(manager.shr_events.ring->oldest), manager.shr_events.oldest) != BARELOG_SUCCESS
+		|| shared_publish() != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	/* The chunks kept by a previous run of the core go back to the pool. */
+	manager.shr_events.mapped = manager.shr_events.head & ~(manager.shr_events.segment_size - 1);
+	manager.shr_events.segment = BARELOG_CHUNK_NONE;
+	const int8_t released = shared_release(manager.shr_events.head, manager.shr_events.head);
+	if (released != BARELOG_SUCCESS) {
+		return released;
+	}
 
+#if !BARELOG_WRITE_THROUGH_MODE
 	manager.events.head = 0;
 	manager.events.tail = 0;
-	manager.events.full = 0;
-	manager.events.empty = 1;
-
-#if BARELOG_SAFE_MODE
-	mutex_byte_address = platform.mem_space.phy_base + core;
+	manager.events.count = 0;
 #endif
+	manager.reserved = 0;
+	manager.reserving = 0;
+	manager.timestamp = 0;
+	manager.epoch = 0;
+	manager.sequence = 0;
+
+	manager.write_async = NULL;
+	manager.poll = NULL;
+	manager.wait = NULL;
+	manager.nb_transfers = 0;
+	manager.transfer_tail = 0;
+
+	/* The requests sent before the initialization are ignored. */
+	manager.beacon = (barelog_sync_beacon_t *) (shared + header.sync_offset) + manager.core;
+	if (manager.read(&(manager.beacon->request), sizeof(uint32_t),
+		&(manager.sync_reply)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+
+	/* The statistics of a previous run of the core are reset. */
+	memset(&(manager.stats), 0, sizeof(barelog_core_stats_t));
+	manager.shr_stats = (barelog_core_stats_t *) (shared + header.stats_offset) + manager.core;
+	if (device_mem_manager_publish_stats() != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
 
 	manager.initialized = 1;
 
-	return BARELOG_NB_CORES;
+	return header.nb_cores;
+}
+
+/* Stores an epoch marker, the clock having wrapped before the timestamp. */
+static int8_t epoch_mark(uint32_t timestamp) {
+	uint32_t *epoch = NULL;
+
+	manager.timestamp = timestamp;
+	++manager.epoch;
+
+	int8_t ret = device_mem_manager_reserve(timestamp, BARELOG_RECORD_EPOCH,
+		sizeof(uint32_t), (void **) &epoch);
+	if (!epoch) {
+		return ret;
+	}
+	*epoch = manager.epoch;
+
+	return device_mem_manager_commit(sizeof(uint32_t));
+}
+
+#if BARELOG_WRITE_THROUGH_MODE
+
+/* Returns the header of the record starting at a given counter. */
+static inline barelog_record_header_t *record_header(uint32_t counter) {
+	return (barelog_record_header_t *) shared_record(counter);
+}
+
+/* Copies the header of the record starting at a given counter. */
+static inline int8_t record_read(uint32_t counter, barelog_record_header_t *header) {
+	return manager.read(record_header(counter), sizeof(barelog_record_header_t), header);
+}
+
+/* Returns 1 if the records ending at the end counter fit into the shared ring
+ * without applying the memory policy, 0 otherwise. */
+static inline uint8_t shared_fits(uint32_t end) {
+	uint32_t count = 1;
+
+	/* A new chunk may also be needed, while the pool is exhausted. */
+	if (manager.shr_events.chain && (int32_t) (end - manager.shr_events.mapped) > 0) {
+		manager.read(&(manager.shr_events.pool->count), sizeof(uint32_t), &count);
+	}
+
+	return shared_span(shared_oldest(), end) <= manager.shr_events.size && count;
+}
+
+uint16_t device_mem_manager_room(void) {
+	const uint32_t head = manager.shr_events.head;
+	const uint32_t record_size = BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE);
+	const uint32_t max_end = head + shared_padding(head, record_size, 0) + record_size;
+
+	if (shared_fits(max_end)) {
+		return BARELOG_BUF_MAX_SIZE;
+	}
+	/* The host may have consumed some records since the last reading. */
+	if (manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS || shared_fits(max_end)) {
+		return BARELOG_BUF_MAX_SIZE;
+	}
+
+	/* Largest record fitting either before the end of the segment, or at the
+	 * beginning of the next one (after a padding). */
+	const uint32_t segment_size = manager.shr_events.segment_size;
+	const uint32_t end = segment_size - (head & (segment_size - 1));
+	uint32_t size = 0;
+	if (manager.shr_events.chain) {
+		/* The chunks of the pool are taken by whole segments. */
+		if (shared_fits(head + end + segment_size)) {
+			size = segment_size;
+		} else if (shared_fits(head + end)) {
+			size = end;
+		}
+	} else {
+		const uint32_t used = head - shared_oldest();
+		const uint32_t free = (used < manager.shr_events.size) ? manager.shr_events.size - used : 0;
+		size = (end < free) ? end : free;
+		if (free > end && free - end > size) {
+			size = free - end;
+		}
+	}
+	if (size <= BARELOG_RECORD_HEADER_SIZE) {
+		return 0;
+	}
+	size -= BARELOG_RECORD_HEADER_SIZE;
+
+	return (size > BARELOG_BUF_MAX_SIZE) ? BARELOG_BUF_MAX_SIZE : (uint16_t) size;
+}
+
+/* Reserves a record of the given size for an event whose number is already
+ * known (see device_mem_manager_reserve). */
+static int8_t record_reserve(uint32_t timestamp, uint16_t sequence, uint8_t info,
+	uint16_t size, void **data) {
+	*data = NULL;
+	const uint32_t record_size = BARELOG_RECORD_SIZE(size);
+	uint32_t padding = shared_padding(manager.shr_events.head, record_size, 0);
+
+	int8_t ret = shared_room(padding + record_size);
+	if (ret != BARELOG_SUCCESS) {
+		/* Whatever the reason, the event is lost. */
+		++manager.stats.dropped;
+		const int8_t changed = stats_changed();
+		return (ret == BARELOG_SHARED_SKIPPED) ? changed : ret;
+	}
+	shared_padding(manager.shr_events.head, record_size, 1);
+
+	/* The record is only published by the commit. */
+	const uint32_t counter = manager.shr_events.head + padding;
+	const barelog_record_header_t header = {
+		.timestamp = timestamp,
+		.sequence = sequence,
+		.length = size,
+		.info = info
+	};
+	if (manager.write(record_header(counter), sizeof(header), &header) != BARELOG_SUCCESS) {
+		ret = BARELOG_SHRMEM_WRITE_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret, "shared memory writing error");
+		return ret;
+	}
+
+	manager.reserved = counter;
+	manager.reserving = 1;
+	/* The event's data is directly written into the shared memory. */
+	*data = (uint8_t *) record_header(counter) + BARELOG_RECORD_HEADER_SIZE;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_commit(uint16_t length) {
+	const uint32_t counter = manager.reserved;
+	barelog_record_header_t header;
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	int8_t ret = 0;
+	if (!manager.reserving || record_read(counter, &header) != BARELOG_SUCCESS
+		|| length > header.length) {
+		ret = BARELOG_INCONSISTENT_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_commit param");
+		return ret;
+	}
+#endif
+
+	header.length = length;
+	if (manager.write(&(record_header(counter)->length), sizeof(header.length),
+		&(header.length)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	manager.reserving = 0;
+
+	manager.stats.bytes += counter + BARELOG_RECORD_SIZE(length) - manager.shr_events.head;
+	++manager.stats.flushed;
+	manager.shr_events.head = counter + BARELOG_RECORD_SIZE(length);
+
+	const int8_t published = shared_publish();
+	return (published == BARELOG_SUCCESS) ? stats_changed() : published;
+}
+
+inline int8_t device_mem_manager_clean_buffer(void) {
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_clean(uint32_t n) {
+	/* The records are never buffered locally. */
+	(void) n;
+	return BARELOG_SUCCESS;
+}
+
+inline int8_t device_mem_manager_flush_buffer(void) {
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_flush(uint32_t n) {
+	/* The records are stored into the shared memory by their commit. */
+	(void) n;
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_is_buffer_full(void) {
+	const uint32_t record_size = BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE);
+
+	return !shared_fits(manager.shr_events.head
+		+ shared_padding(manager.shr_events.head, record_size, 0) + record_size);
+}
+
+#else
+
+/* Returns the header of the record starting at a given counter. */
+static inline barelog_record_header_t *record_header(uint32_t counter) {
+	return (barelog_record_header_t *) &(manager.events.buffer[counter & BARELOG_LOCAL_BUFFER_MASK]);
+}
+
+/* Copies the header of the record starting at a given counter. */
+static inline int8_t record_read(uint32_t counter, barelog_record_header_t *header) {
+	*header = *record_header(counter);
+	return BARELOG_SUCCESS;
+}
+
+uint16_t device_mem_manager_room(void) {
+	const uint32_t used = manager.events.head - local_tail();
+	const uint32_t free = BARELOG_LOCAL_BUFFER_SIZE - used;
+	const uint32_t end = BARELOG_LOCAL_BUFFER_SIZE - (manager.events.head & BARELOG_LOCAL_BUFFER_MASK);
+
+	/* Largest record fitting either before the end of the buffer, or at its
+	 * beginning (after a padding). */
+	uint32_t size = (end < free) ? end : free;
+	if (free > end && free - end > size) {
+		size = free - end;
+	}
+	if (size <= BARELOG_RECORD_HEADER_SIZE) {
+		return 0;
+	}
+	size -= BARELOG_RECORD_HEADER_SIZE;
+
+	return (size > BARELOG_BUF_MAX_SIZE) ? BARELOG_BUF_MAX_SIZE : (uint16_t) size;
 }
 
-int8_t device_mem_manager_write_buffer(barelog_event_t event) {
-	if (manager.events.full) {
-		int8_t ret = 0;
-		(void) ret;
+/* Reserves a record of the given size for an event whose number is already
+ * known (see device_mem_manager_reserve). */
+static int8_t record_reserve(uint32_t timestamp, uint16_t sequence, uint8_t info,
+	uint16_t size, void **data) {
+	*data = NULL;
+	int8_t ret = 0;
+	(void) ret;
+	const uint32_t record_size = BARELOG_RECORD_SIZE(size);
+
+	/* With asynchronous flushes, the buffer is flushed as soon as half of it
+	 * is used : the events are logged into one half while the other one
+	 * is transferred. */
+	if (manager.write_async && manager.buffer_policy == FLUSH
+		&& manager.events.head - manager.events.tail + record_size > BARELOG_LOCAL_BUFFER_SIZE / 2) {
+		ret = device_mem_manager_flush_buffer();
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+		if (ret != BARELOG_SUCCESS) {
+			BARELOG_DEBUG(__FILE__, __LINE__, ret,
+				"device_mem_manager_flush_buffer call");
+			return ret;
+		}
+#endif
+		device_mem_manager_clean_buffer();
+	}
+
+	uint32_t padding = local_room(record_size);
+
+	/* The room may only be taken by a pending transfer. */
+	if (padding == BARELOG_LOCAL_BUFFER_SIZE && manager.nb_transfers) {
+		ret = device_mem_manager_wait_flush();
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+		if (ret != BARELOG_SUCCESS) {
+			BARELOG_DEBUG(__FILE__, __LINE__, ret,
+				"device_mem_manager_wait_flush call");
+			return ret;
+		}
+#endif
+		padding = local_room(record_size);
+	}
+
+	if (padding == BARELOG_LOCAL_BUFFER_SIZE) {
 		switch (manager.buffer_policy) {
 		case SKIP:
-			return BARELOG_SUCCESS;
+			++manager.stats.dropped;
+			return stats_changed();
 			break;
 		case REPLACE:
-			manager.events.tail = (manager.events.tail + 1)
-				% BARELOG_EVENT_PER_CORE_MAX;
-			break;
-		case FLUSH:
-			ret = device_mem_manager_flush_buffer();
-#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+			while (padding == BARELOG_LOCAL_BUFFER_SIZE && manager.events.count) {
+				device_mem_manager_clean(1);
+				++manager.stats.overwritten;
+				padding = local_room(record_size);
+			}
+			ret = stats_changed();
 			if (ret != BARELOG_SUCCESS) {
-				BARELOG_DEBUG(__FILE__, __LINE__, ret,
-					"device_mem_manager_flush_buffer call");
 				return ret;
 			}
+			break;
+		case FLUSH: {
+			/* Only the oldest records are moved to the shared memory, until
+			 * the new one fits : the others remain buffered. */
+			const uint32_t position = manager.events.head & BARELOG_LOCAL_BUFFER_MASK;
+			const uint32_t needed = record_size + ((position + record_size > BARELOG_LOCAL_BUFFER_SIZE) ?
+				BARELOG_LOCAL_BUFFER_SIZE - position : 0);
+			uint32_t counter = manager.events.tail;
+			uint32_t n = 0;
+			while (n < manager.events.count
+				&& manager.events.head - counter + needed > BARELOG_LOCAL_BUFFER_SIZE) {
+				counter += BARELOG_RECORD_SIZE(local_record(&counter)->length);
+				++n;
+			}
+			if (n) {
+				ret = device_mem_manager_flush(n);
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+				if (ret != BARELOG_SUCCESS) {
+					BARELOG_DEBUG(__FILE__, __LINE__, ret,
+						"device_mem_manager_flush call");
+					return ret;
+				}
 #endif
+				device_mem_manager_clean(n);
+			}
+			padding = local_room(record_size);
 			break;
+		}
 		case DESTROY:
 			ret = device_mem_manager_flush_buffer();
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
@@ -186,45 +907,86 @@ int8_t device_mem_manager_write_buffer(barelog_event_t event) {
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
 			if (ret != BARELOG_SUCCESS) {
 				BARELOG_DEBUG(__FILE__, __LINE__, ret,
-					"device_mem_manager_cleah_buffer call");
+					"device_mem_manager_clean_buffer call");
 				return ret;
 			}
 #endif
+			padding = local_room(record_size);
 			break;
 		default:
 			BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_ERR, "unrecognized policy");
 			return BARELOG_ERR;
 		}
+
+		/* The flushed records are released at the end of their transfer. */
+		if (padding == BARELOG_LOCAL_BUFFER_SIZE && manager.nb_transfers) {
+			ret = device_mem_manager_wait_flush();
+			if (ret != BARELOG_SUCCESS) {
+				return ret;
+			}
+			padding = local_room(record_size);
+		}
+		if (padding == BARELOG_LOCAL_BUFFER_SIZE) {
+			++manager.stats.dropped;
+			return stats_changed();
+		}
 	}
 
-	manager.events.buffer[manager.events.head] = event;
-	manager.events.buffer[manager.events.head].core = manager.core;
-	manager.events.empty = 0;
+	/* The record does not fit at the end of the buffer : the following
+	 * records are stored at the beginning. */
+	const uint32_t position = manager.events.head & BARELOG_LOCAL_BUFFER_MASK;
+	if (padding && position + BARELOG_RECORD_HEADER_SIZE <= BARELOG_LOCAL_BUFFER_SIZE) {
+		((barelog_record_header_t *) &(manager.events.buffer[position]))->length = BARELOG_RECORD_SKIP;
+	}
+
+	const uint32_t counter = manager.events.head + padding;
+	barelog_record_header_t *header = record_header(counter);
+	header->timestamp = timestamp;
+	header->sequence = sequence;
+	header->length = size;
+	header->info = info;
 
-	manager.events.head = (manager.events.head + 1) % BARELOG_EVENT_PER_CORE_MAX;
+	manager.reserved = counter;
+	manager.reserving = 1;
+	*data = (uint8_t *) header + BARELOG_RECORD_HEADER_SIZE;
 
-	/* If the next case to fulfill is already taken */
-	if (manager.events.head == manager.events.tail) {
-		/* The buffer is full */
-		manager.events.full = 1;
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_commit(uint16_t length) {
+	const uint32_t counter = manager.reserved;
+	barelog_record_header_t *header = record_header(counter);
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	int8_t ret = 0;
+	if (!manager.reserving || length > header->length) {
+		ret = BARELOG_INCONSISTENT_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_commit param");
+		return ret;
 	}
+#endif
+
+	header->length = length;
+	manager.reserving = 0;
+
+	manager.events.head = counter + BARELOG_RECORD_SIZE(length);
+	++manager.events.count;
 
 	return BARELOG_SUCCESS;
 }
 
 inline int8_t device_mem_manager_clean_buffer(void) {
-	uint32_t events_to_read =
-			(manager.events.full) ?
-				BARELOG_EVENT_PER_CORE_MAX :
-				(mod((manager.events.head - manager.events.tail),
-					BARELOG_EVENT_PER_CORE_MAX));
-	return device_mem_manager_clean(events_to_read);
+	if (!manager.events.count) {
+		return BARELOG_SUCCESS;
+	}
+	return device_mem_manager_clean(manager.events.count);
 }
 
 int8_t device_mem_manager_clean(uint32_t n) {
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
 	int8_t ret = 0;
-	if (n <= 0 || n > BARELOG_EVENT_PER_CORE_MAX) {
+	if (n <= 0) {
 		ret = BARELOG_INCONSISTENT_PARAM_ERR;
 		BARELOG_DEBUG(__FILE__, __LINE__, ret,
 			"device_mem_manager_clean param");
@@ -232,34 +994,28 @@ int8_t device_mem_manager_clean(uint32_t n) {
 	}
 #endif
 
-	if (manager.events.empty) {
+	if (n >= manager.events.count) {
+		manager.events.tail = manager.events.head;
+		manager.events.count = 0;
 		return BARELOG_SUCCESS;
 	}
 
-	uint32_t ind = 0;
-	uint32_t imax = mod((manager.events.head - 1), BARELOG_EVENT_PER_CORE_MAX);
+	uint32_t counter = manager.events.tail;
 	for (uint32_t i = 0; i < n; ++i) {
-		ind = (manager.events.tail + i) % BARELOG_EVENT_PER_CORE_MAX;
-		manager.events.buffer[ind] = BARELOG_EVENT_INITIALIZER;
-		if (ind == imax) {
-			manager.events.empty = 1;
-			break;
-		}
+		counter += BARELOG_RECORD_SIZE(local_record(&counter)->length);
 	}
 
-	manager.events.tail = (ind + 1) % BARELOG_EVENT_PER_CORE_MAX;
-	manager.events.full = 0;
+	manager.events.tail = counter;
+	manager.events.count -= n;
 
 	return BARELOG_SUCCESS;
 }
 
 inline int8_t device_mem_manager_flush_buffer(void) {
-	uint32_t events_to_read =
-			(manager.events.full) ?
-				BARELOG_EVENT_PER_CORE_MAX :
-				(mod((manager.events.head - manager.events.tail),
-					BARELOG_EVENT_PER_CORE_MAX));
-	return device_mem_manager_flush(events_to_read);
+	if (!manager.events.count) {
+		return BARELOG_SUCCESS;
+	}
+	return device_mem_manager_flush(manager.events.count);
 }
 
 int8_t device_mem_manager_flush(uint32_t n) {
@@ -267,124 +1023,369 @@ int8_t device_mem_manager_flush(uint32_t n) {
 	(void) ret;
 
 #if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
-	if (n <= 0 || n > BARELOG_EVENT_PER_CORE_MAX) {
+	if (n <= 0) {
 		ret = BARELOG_INCONSISTENT_PARAM_ERR;
 		BARELOG_DEBUG(__FILE__, __LINE__, ret,
-			"device_mem_manager_clean param");
+			"device_mem_manager_flush param");
 		return ret;
 	}
 #endif
 
-	uint32_t nmax = n;
-	uint32_t n1 = 0;
-	uint32_t n2 = 0;
-
-	uint32_t events_to_read =
-		(manager.events.full) ?
-			BARELOG_EVENT_PER_CORE_MAX :
-			(mod((manager.events.head - manager.events.tail),
-				BARELOG_EVENT_PER_CORE_MAX));
-
-	if (events_to_read == 0) {
+	if (manager.events.count == 0) {
 		return BARELOG_SUCCESS;
 	}
 
+	/* The shared memory (and the local buffer) must not be changed by
+	 * a previous asynchronous flush anymore. */
+	ret = device_mem_manager_wait_flush();
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (ret != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_wait_flush call");
+		return ret;
+	}
+#endif
+
 	// We make sure we don't read more events than there are available.
-	nmax = (n > events_to_read) ? events_to_read : n;
+	const uint32_t nmax = (n > manager.events.count) ? manager.events.count : n;
 
-	uint32_t barelog_total_events_size = nmax * sizeof(barelog_event_t);
+	/* The records are not split inside the shared ring either : computes the
+	 * size they take there. */
+	uint32_t counter = manager.events.tail;
+	uint32_t head = manager.shr_events.head;
+	for (uint32_t i = 0; i < nmax; ++i) {
+		const uint32_t size = BARELOG_RECORD_SIZE(local_record(&counter)->length);
+		head += shared_padding(head, size, 0) + size;
+		counter += size;
+	}
 
-	if ((manager.shr_events.imax - manager.shr_events.index + 1) < nmax) {
-		switch (manager.memory_policy) {
-		case SKIP:
-			return BARELOG_SUCCESS;
-			break;
-		case REPLACE:
-			manager.shr_events.index = 0;
-			break;
-		case DESTROY:
-			manager.shr_events.index = 0;
-			ret = device_mem_manager_clean_memory();
-#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
-			if (ret != BARELOG_SUCCESS) {
+	ret = shared_room(head - manager.shr_events.head);
+	if (ret == BARELOG_SHARED_SKIPPED) {
+		/* The records skipped by the memory policy are dropped by the
+		 * caller's clean. */
+		manager.stats.dropped += nmax;
+		return stats_changed();
+	}
+	if (ret != BARELOG_SUCCESS) {
+		/* The records remain buffered. */
+		return ret;
+	}
+	manager.stats.flushed += nmax;
+	manager.stats.bytes += head - manager.shr_events.head;
+
+	/* The records are copied by (at most three) contiguous runs, which are
+	 * interrupted by the end of the local buffer and of a segment of the
+	 * shared ring. */
+	uint32_t source = 0;
+	uint8_t *destination = NULL;
+	uint32_t length = 0;
+	counter = manager.events.tail;
+	head = manager.shr_events.head;
+	manager.transfer_tail = manager.events.tail;
+	for (uint32_t i = 0; i <= nmax; ++i) {
+		uint32_t size = 0;
+		if (i < nmax) {
+			size = BARELOG_RECORD_SIZE(local_record(&counter)->length);
+			head += shared_padding(head, size, 1);
+		}
+		if (length && (i == nmax || (counter & BARELOG_LOCAL_BUFFER_MASK) != source + length
+			|| shared_record(head) != destination + length)) {
+			if (shared_write(destination, length,
+				(const void *) (&(manager.events.buffer[source]))) != BARELOG_SUCCESS) {
+				ret = BARELOG_SHRMEM_WRITE_ERR;
 				BARELOG_DEBUG(__FILE__, __LINE__, ret,
-					"device_mem_manager_clean_memory call");
+					"shared memory writing error");
 				return ret;
 			}
-#endif
+			length = 0;
+		}
+		if (i == nmax) {
 			break;
-		default:
-			BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_ERR, "unrecognized policy");
-			return BARELOG_ERR;
 		}
+		if (!length) {
+			source = counter & BARELOG_LOCAL_BUFFER_MASK;
+			destination = shared_record(head);
+		}
+		length += size;
+		counter += size;
+		head += size;
 	}
 
-	barelog_try_mutex(); barelog_set_mutex(1);
+	manager.shr_events.head = head;
 
-	/* If there are too many events, we must have to separate the writings
-	 * in two : first the section from tail to BARELOG_EVENT_PER_CORE_MAX - 1
-	 * then the section from 0 to nmax.
-	 *
-	 * Otherwise we just flush the buffer from the tail of the queue to nmax.
-	 */
-	if ((manager.events.tail + nmax - 1) >= BARELOG_EVENT_PER_CORE_MAX) {
-		n1 = BARELOG_EVENT_PER_CORE_MAX - manager.events.tail;
-		if (n1) {
-			if (manager.write(
-				&(manager.shr_events.events[manager.shr_events.index]),
-				n1 * sizeof(barelog_event_t),
-				(const void *) (&(manager.events.buffer[manager.events.tail]))) != BARELOG_SUCCESS) {
-				barelog_set_mutex(0);
-				ret = BARELOG_SHRMEM_WRITE_ERR;
-				BARELOG_DEBUG(__FILE__, __LINE__, ret,
-					"shared memory writing error");
-				return ret;
-			}
+	/* The records are published at the end of the asynchronous transfers. */
+	if (!manager.nb_transfers) {
+		ret = shared_publish();
+		if (ret != BARELOG_SUCCESS) {
+			return ret;
 		}
-		n2 = nmax - n1;
-		if (n2) {
-			if (manager.write(
-				&(manager.shr_events.events[manager.shr_events.index]),
-				n2 * sizeof(barelog_event_t),
-				(const void *) (&(manager.events.buffer[0]))) != BARELOG_SUCCESS) {
-				barelog_set_mutex(0);
-				ret = BARELOG_SHRMEM_WRITE_ERR;
-				BARELOG_DEBUG(__FILE__, __LINE__, ret,
-					"shared memory writing error");
-				return ret;
-			}
+	}
+
+	return stats_changed();
+}
+
+int8_t device_mem_manager_is_buffer_full(void) {
+	return local_room(BARELOG_RECORD_SIZE(BARELOG_BUF_MAX_SIZE)) == BARELOG_LOCAL_BUFFER_SIZE;
+}
+
+#endif // BARELOG_WRITE_THROUGH_MODE
+
+int8_t device_mem_manager_reserve(uint32_t timestamp, uint8_t info, uint16_t size, void **data) {
+	if (size > BARELOG_BUF_MAX_SIZE) {
+		size = BARELOG_BUF_MAX_SIZE;
+	}
+
+	*data = NULL;
+	if (timestamp < manager.timestamp) {
+		const int8_t marked = epoch_mark(timestamp);
+		if (marked != BARELOG_SUCCESS) {
+			return marked;
 		}
-	} else {
-		if (manager.write(&(manager.shr_events.events[manager.shr_events.index]),
-			barelog_total_events_size,
-			(const void *) (&(manager.events.buffer[manager.events.tail]))) != BARELOG_SUCCESS) {
-			barelog_set_mutex(0);
+	}
+	manager.timestamp = timestamp;
+	/* The epoch markers take the number of the next event. */
+	const uint16_t sequence = (info & BARELOG_RECORD_EPOCH) ?
+		manager.sequence : manager.sequence++;
+
+	return record_reserve(timestamp, sequence, info, size, data);
+}
+
+int8_t device_mem_manager_resize(uint16_t size, void **data) {
+	*data = NULL;
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	int8_t ret = 0;
+	if (!manager.reserving) {
+		ret = BARELOG_INCONSISTENT_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_resize param");
+		return ret;
+	}
+#endif
+
+	if (size > BARELOG_BUF_MAX_SIZE) {
+		size = BARELOG_BUF_MAX_SIZE;
+	}
+
+	/* The event keeps its timestamp and its number. */
+	barelog_record_header_t header;
+	if (record_read(manager.reserved, &header) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	manager.reserving = 0;
+
+	return record_reserve(header.timestamp, header.sequence, header.info, size, data);
+}
 
+int8_t device_mem_manager_write_buffer(const barelog_event_t *event, uint16_t length) {
+	void *data = NULL;
+	int8_t ret = device_mem_manager_reserve(event->timestamp,
+		event->level & BARELOG_RECORD_LEVEL_MASK, length, &data);
+
+	if (!data) {
+		return ret;
+	}
+
+	if (length > BARELOG_BUF_MAX_SIZE) {
+		length = BARELOG_BUF_MAX_SIZE;
+	}
+	memcpy(data, event->data, length);
+
+	return device_mem_manager_commit(length);
+}
+
+int8_t device_mem_manager_set_async(
+		int8_t (*write_async)(void * address, size_t size,
+				const void *buffer, uint32_t *handle),
+		int8_t (*poll)(uint32_t handle),
+		int8_t (*wait)(uint32_t handle)) {
+	int8_t ret = 0;
+
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	if (!write_async != !poll || !write_async != !wait) {
+		ret = BARELOG_UNINITIALIZED_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_set_async param");
+		return ret;
+	}
+#endif
+
+	ret = device_mem_manager_wait_flush();
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+
+	manager.write_async = write_async;
+	manager.poll = poll;
+	manager.wait = wait;
+
+	return BARELOG_SUCCESS;
+}
+
+int8_t device_mem_manager_wait_flush(void) {
+	if (!manager.nb_transfers) {
+		return BARELOG_SUCCESS;
+	}
+
+	int8_t ret = BARELOG_SUCCESS;
+	for (uint8_t i = 0; i < manager.nb_transfers; ++i) {
+		if (manager.wait(manager.transfers[i]) != BARELOG_SUCCESS) {
 			ret = BARELOG_SHRMEM_WRITE_ERR;
-			BARELOG_DEBUG(__FILE__, __LINE__, ret,
-				"shared memory writing error");
+		}
+	}
+	manager.nb_transfers = 0;
+
+	if (ret != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"asynchronous shared memory writing error");
+		return ret;
+	}
+
+	return shared_publish();
+}
+
+int8_t device_mem_manager_is_flush_done(void) {
+	for (uint8_t i = 0; i < manager.nb_transfers; ++i) {
+		if (manager.poll(manager.transfers[i]) == 0) {
+			return 0;
+		}
+	}
+	device_mem_manager_wait_flush();
+
+	return 1;
+}
+
+int8_t device_mem_manager_sync(uint32_t (*get_clock)(void)) {
+	uint32_t request = 0;
+
+	/* An epoch marker would overwrite the record reserved : the request is
+	 * answered by a later call. */
+	if (manager.reserving) {
+		return 0;
+	}
+	if (manager.read(&(manager.beacon->request), sizeof(uint32_t), &request) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	if (request == manager.sync_reply) {
+		return 0;
+	}
+
+	/* The clock is read as close as possible to the request. */
+	const uint32_t timestamp = get_clock();
+	if (timestamp < manager.timestamp) {
+		const int8_t ret = epoch_mark(timestamp);
+		if (ret != BARELOG_SUCCESS) {
+			return ret;
+		}
+	}
+	manager.timestamp = timestamp;
+
+	const uint32_t clock[2] = { manager.epoch, timestamp };
+	if (manager.write(&(manager.beacon->epoch), sizeof(clock), clock) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	barelog_memory_barrier();
+	if (manager.write(&(manager.beacon->reply), sizeof(uint32_t), &request) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
+	manager.sync_reply = request;
+
+	const int8_t ret = device_mem_manager_publish_stats();
+	return (ret == BARELOG_SUCCESS) ? 1 : ret;
+}
+
+int8_t device_mem_manager_clean_memory(void) {
+	int8_t ret = device_mem_manager_wait_flush();
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+
+	/* Counts the records not consumed by the host yet. */
+	if (manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS) {
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+	const uint32_t from = shared_oldest();
+	for (uint32_t counter = from; (int32_t) (manager.shr_events.head - counter) > 0; ) {
+		ret = shared_next(&counter);
+		if (ret < 0) {
+			return ret;
+		}
+		manager.stats.overwritten += ret;
+	}
+
+	/* The host drops the records it might be reading. */
+	manager.shr_events.oldest = manager.shr_events.head;
+	ret = shared_control(&(manager.shr_events.ring->oldest), manager.shr_events.oldest);
+	if (ret != BARELOG_SUCCESS) {
+		return ret;
+	}
+	barelog_memory_barrier();
+
+	if (manager.shr_events.chain) {
+		ret = shared_release(from, manager.shr_events.head);
+		if (ret != BARELOG_SUCCESS) {
 			return ret;
 		}
-	} barelog_set_mutex(0);
+	} else {
+		memset(manager.shr_events.records, 0, manager.shr_events.size);
+	}
 
-	manager.shr_events.index += nmax;
+	return stats_changed();
+}
 
-	ret = BARELOG_SUCCESS;
-	BARELOG_DEBUG(__FILE__, __LINE__, ret, "flushing success !");
+int8_t device_mem_manager_publish_stats(void) {
+	manager.stats_changes = 0;
+	if (manager.write(manager.shr_stats, sizeof(barelog_core_stats_t),
+		(const void *) &(manager.stats)) != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_SHRMEM_WRITE_ERR,
+			"shared memory writing error");
+		return BARELOG_SHRMEM_WRITE_ERR;
+	}
 
 	return BARELOG_SUCCESS;
 }
 
-int8_t device_mem_manager_clean_memory(void) {
-	barelog_try_mutex(); barelog_set_mutex(1);
-	memset(manager.mem_space.base, 0, manager.mem_space.length);
-	barelog_set_mutex(0);
+int8_t device_mem_manager_set_buffer_policy(barelog_policy_t policy,
+		barelog_policy_t *previous) {
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	int8_t ret = 0;
+	if (policy > DESTROY) {
+		ret = BARELOG_INCONSISTENT_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_set_buffer_policy param");
+		return ret;
+	}
+#endif
 
-	manager.shr_events.index = 0;
+	if (previous) {
+		*previous = manager.buffer_policy;
+	}
+	manager.buffer_policy = policy;
 
 	return BARELOG_SUCCESS;
 }
 
-int8_t device_mem_manager_is_buffer_full(void) {
-	return manager.events.full;
+int8_t device_mem_manager_occupancy(uint32_t *used, uint32_t *size) {
+#if BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE
+	int8_t ret = 0;
+	if (!used || !size) {
+		ret = BARELOG_UNINITIALIZED_PARAM_ERR;
+		BARELOG_DEBUG(__FILE__, __LINE__, ret,
+			"device_mem_manager_occupancy param");
+		return ret;
+	}
+#endif
+
+	/* The host may have consumed some records since the last reading. */
+	if (manager.read(&(manager.shr_events.ring->tail), sizeof(uint32_t),
+		&(manager.shr_events.tail)) != BARELOG_SUCCESS) {
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_SHRMEM_READ_ERR,
+			"shared memory reading error");
+		return BARELOG_SHRMEM_READ_ERR;
+	}
+
+	*used = shared_span(shared_oldest(), manager.shr_events.head);
+	*size = manager.shr_events.size;
+
+	return BARELOG_SUCCESS;
 }
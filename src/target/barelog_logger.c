@@ -28,9 +28,29 @@
 #include "barelog_event.h"
 #include "barelog_internal.h"
 #include "include/barelog_snprintf.h"
+#if BARELOG_BINARY_MODE
+#include "barelog_binary.h"
+#endif
 
 static barelog_logger_t logger;
 
+barelog_lvl_t barelog_log_lvl BARELOG_LOCAL_MEM_ATTRIBUTE = BARELOG_DEFAULT_LOG_LVL;
+
+#if BARELOG_BINARY_MODE
+/* Bounds of the log sites section (provided by the linker). */
+extern const barelog_site_t __start_barelog_fmt[] __attribute__ ((weak));
+extern const barelog_site_t __stop_barelog_fmt[] __attribute__ ((weak));
+#endif
+
+/* Smallest room worth formatting an event into. */
+#if BARELOG_BINARY_MODE && UINTPTR_MAX > UINT32_MAX
+#define BARELOG_DATA_MIN_SIZE BARELOG_BINARY_FORMAT64_HEADER_SIZE
+#elif BARELOG_BINARY_MODE
+#define BARELOG_DATA_MIN_SIZE BARELOG_BINARY_FORMAT_HEADER_SIZE
+#else
+#define BARELOG_DATA_MIN_SIZE 1
+#endif
+
 static uint32_t default_get_clock(void) {
 	return 0;
 }
@@ -45,12 +65,23 @@ int8_t barelog_init_logger(const uint32_t my_core,
 		int8_t (*my_init_clock)(void),
 		int8_t (*my_start_clock)(void)) {
 
-	device_mem_manager_init(my_core, platform, buffer_policy, memory_policy, read, write);
+#if (BARELOG_CHECK_MODE || BARELOG_DEBUG_MODE) && BARELOG_BINARY_MODE
+	/* The events only hold 16 bits site ids. */
+	if (__stop_barelog_fmt - __start_barelog_fmt > BARELOG_MAX_SITES) {
+		BARELOG_DEBUG(__FILE__, __LINE__, BARELOG_INCONSISTENT_PARAM_ERR, "barelog_init_logger sites");
+		return BARELOG_INCONSISTENT_PARAM_ERR;
+	}
+#endif
+
+	const int32_t ret = device_mem_manager_init(my_core, platform, buffer_policy, memory_policy, read, write);
+	if (ret < 0) {
+		return ret;
+	}
 
 	logger.get_clock = my_get_clock;
 	logger.init_clock = my_init_clock;
 	logger.start_clock = my_start_clock;
-	logger.log_lvl = BARELOG_DEFAULT_LOG_LVL;
+	barelog_log_lvl = BARELOG_DEFAULT_LOG_LVL;
 
 	if (!logger.get_clock) {
 		logger.get_clock = default_get_clock;
@@ -72,35 +103,125 @@ int8_t barelog_start(void) {
 	return (ret + logger.start_clock());
 }
 
+/* Formats an event into its reserved data, returns the length of the data
+ * and sets needed to the length the whole event would take. */
+static inline uint16_t barelog_vformat(char *data, uint16_t size,
+	const barelog_site_t *site, const char *format, va_list ap, size_t *needed) {
+#if BARELOG_BINARY_MODE
+	size_t header_size = 0;
+	if (site) {
+		const uint16_t site_id = (uint16_t) (site - __start_barelog_fmt);
+		data[0] = BARELOG_BINARY_SITE_TAG;
+		memcpy(&data[1], &site_id, sizeof(site_id));
+		header_size = BARELOG_BINARY_SITE_HEADER_SIZE;
+	} else {
+		/* The whole address of the format identifies it. */
+#if UINTPTR_MAX > UINT32_MAX
+		const uint64_t format_id = (uintptr_t) format;
+		data[0] = BARELOG_BINARY_FORMAT64_TAG;
+		header_size = BARELOG_BINARY_FORMAT64_HEADER_SIZE;
+#else
+		const uint32_t format_id = (uintptr_t) format;
+		data[0] = BARELOG_BINARY_FORMAT_TAG;
+		header_size = BARELOG_BINARY_FORMAT_HEADER_SIZE;
+#endif
+		memcpy(&data[1], &format_id, sizeof(format_id));
+	}
+	size_t encoded = 0;
+	const uint16_t length = header_size + barelog_binary_vencode(&data[header_size],
+		size - header_size, format, ap, &encoded);
+	*needed = header_size + encoded;
+	return length;
+#else
+	(void) site;
+	int n = portable_vsnprintf(data, size, format, ap);
+	//vsnprintf(data, BARELOG_BUF_MAX_SIZE, format, ap);
+	if (n < 0) {
+		data[0] = '\0';
+		*needed = 1;
+		return 1;
+	}
+	/* The '\0' is kept along with the data. */
+	*needed = (size_t) n + 1;
+	return ((size_t) n >= size) ? size : (uint16_t) (n + 1);
+#endif // BARELOG_BINARY_MODE
+}
+
+static inline int8_t barelog_vlog(barelog_lvl_t lvl, const barelog_site_t *site,
+	const char *format, va_list ap) {
+	char *data = NULL;
+	/* The event is formatted into the room available, the buffer policy is
+	 * only applied if it does not fit. */
+	uint16_t size = device_mem_manager_room();
+	if (size < BARELOG_DATA_MIN_SIZE) {
+		size = BARELOG_BUF_MAX_SIZE;
+	}
+	int8_t ret = device_mem_manager_reserve(logger.get_clock(), (uint8_t) lvl,
+		size, (void **) &data);
+
+	if (!data) {
+		return ret;
+	}
+
+	va_list copy;
+	va_copy(copy, ap);
+	size_t needed = 0;
+	uint16_t length = barelog_vformat(data, size, site, format, copy, &needed);
+	va_end(copy);
+
+	if (needed > size && size < BARELOG_BUF_MAX_SIZE) {
+		size = (needed > BARELOG_BUF_MAX_SIZE) ? BARELOG_BUF_MAX_SIZE : (uint16_t) needed;
+		ret = device_mem_manager_resize(size, (void **) &data);
+		if (!data) {
+			return ret;
+		}
+		length = barelog_vformat(data, size, site, format, ap, &needed);
+	}
+
+	return device_mem_manager_commit(length);
+}
+
 int8_t barelog_log(barelog_lvl_t lvl, const char *format, ...) {
 
-	if (lvl > logger.log_lvl) {
+	if (lvl > barelog_log_lvl) {
 		return -1;
 	}
 
-	barelog_event_t event = BARELOG_EVENT_INITIALIZER;
+	int8_t ret = 0;
+	va_list ap;
+	va_start(ap, format);
+	ret = barelog_vlog(lvl, NULL, format, ap);
+	va_end(ap);
+
+	return ret;
+
+}
+
+#if BARELOG_BINARY_MODE
+int8_t barelog_log_site(const barelog_site_t *site, const char *format, ...) {
 
-	event.timestamp = logger.get_clock();
+	if (site->lvl > barelog_log_lvl) {
+		return -1;
+	}
 
+	int8_t ret = 0;
 	va_list ap;
 	va_start(ap, format);
-	portable_vsnprintf(event.data, BARELOG_BUF_MAX_SIZE, format, ap);
-	//vsnprintf(event.data, BARELOG_BUF_MAX_SIZE, format, ap);
-
+	ret = barelog_vlog(site->lvl, site, format, ap);
 	va_end(ap);
 
-	return device_mem_manager_write_buffer(event);
-
+	return ret;
 }
+#endif // BARELOG_BINARY_MODE
 
 int8_t barelog_immediate_log(barelog_lvl_t lvl, const char *format, ...) {
-	if (lvl > logger.log_lvl) {
+	if (lvl > barelog_log_lvl) {
 		return -1;
 	}
 	int8_t ret = 0;
 	va_list ap;
 	va_start(ap, format);
-	ret += barelog_log(lvl, format, ap);
+	ret += barelog_vlog(lvl, NULL, format, ap);
 	ret += barelog_flush(1);
 	ret += barelog_clean(1);
 	va_end(ap);
@@ -108,10 +229,19 @@ int8_t barelog_immediate_log(barelog_lvl_t lvl, const char *format, ...) {
 	return ret;
 }
 
+int8_t barelog_reserve(uint16_t size, void **data) {
+	/* The log-level of such an event is unknown. */
+	return device_mem_manager_reserve(logger.get_clock(), 0, size, data);
+}
+
+int8_t barelog_sync(void) {
+	return device_mem_manager_sync(logger.get_clock);
+}
+
 void barelog_set_log_lvl(barelog_lvl_t lvl) {
-	logger.log_lvl = lvl;
+	barelog_log_lvl = lvl;
 }
 
 barelog_lvl_t barelog_get_log_lvl(void) {
-	return logger.log_lvl;
+	return barelog_log_lvl;
 }
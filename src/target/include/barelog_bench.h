@@ -0,0 +1,141 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_bench.h
+ * @brief Module measuring the cost of the logging path of the target.
+ *
+ * barelog_log() (for several patterns of format), device_mem_manager_write_buffer(),
+ * device_mem_manager_flush() and device_mem_manager_clean() are called in
+ * a loop for each buffer policy and occupancy of the shared memory, reading
+ * the clock of the core (and optionally a counter of instructions) around
+ * each call. The benchmark runs on the core itself, with the clock given by
+ * the user : on the actual platform as well as natively (see the
+ * barelog-bench tool), the results being plain structures that the core
+ * may write into the shared memory for the host.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#ifndef __BARELOG_BENCH__
+#define __BARELOG_BENCH__
+
+#include <stdint.h>
+
+#include "barelog_logger.h"
+
+/** Number of occupancies of the shared memory measured (empty, half and full). */
+#define BARELOG_BENCH_NB_OCCUPANCIES 3
+
+/** Number of events flushed or cleaned by each measured call. */
+#define BARELOG_BENCH_BATCH 8
+
+/**
+ * Functions measured.
+ */
+typedef enum {
+	BARELOG_BENCH_LOG,
+	BARELOG_BENCH_WRITE_BUFFER,
+	BARELOG_BENCH_FLUSH,
+	BARELOG_BENCH_CLEAN,
+	BARELOG_BENCH_NB_APIS
+} barelog_bench_api_t;
+
+/**
+ * Patterns of the format given to barelog_log().
+ */
+typedef enum {
+	/** a constant string */
+	BARELOG_BENCH_NO_ARGS,
+	/** integers only */
+	BARELOG_BENCH_INTS,
+	/** strings only */
+	BARELOG_BENCH_STRINGS,
+	/** strings, integers and a character */
+	BARELOG_BENCH_MIXED,
+	BARELOG_BENCH_NB_PATTERNS
+} barelog_bench_pattern_t;
+
+/** Maximum number of results of a benchmark : barelog_log() and
+ * device_mem_manager_write_buffer() for each buffer policy and occupancy,
+ * device_mem_manager_flush() for each occupancy and device_mem_manager_clean(). */
+#define BARELOG_BENCH_MAX_RESULTS ((BARELOG_BENCH_NB_PATTERNS + 1) * (DESTROY + 1) \
+	* BARELOG_BENCH_NB_OCCUPANCIES + BARELOG_BENCH_NB_OCCUPANCIES + 1)
+
+/**
+ * Configuration of a benchmark.
+ */
+typedef struct {
+	/** number of measured calls of each function */
+	uint32_t iterations;
+	/** clock of the core (usually the one given to barelog_init_logger) */
+	uint32_t (*get_clock)(void);
+	/** (optional) counter of the instructions executed by the core */
+	uint32_t (*get_instructions)(void);
+} barelog_bench_config_t;
+
+/**
+ * Cost of a function in a given configuration. The costs are given without
+ * the ones of reading the clock and the counter of instructions.
+ */
+typedef struct {
+	/** sum of the clock cycles taken by the calls */
+	uint64_t cycles;
+	/** sum of the instructions executed by the calls (0 if not counted) */
+	uint64_t instructions;
+	/** function measured (see barelog_bench_api_t) */
+	uint32_t api;
+	/** pattern of the format (see barelog_bench_pattern_t, barelog_log() only) */
+	uint32_t pattern;
+	/** buffer policy applied (see barelog_policy_t) */
+	uint32_t buffer_policy;
+	/** occupancy (in percents) of the shared memory before the calls */
+	uint32_t occupancy;
+	/** number of calls */
+	uint32_t calls;
+	/** number of calls which returned an error code */
+	uint32_t errors;
+	/** clock cycles taken by the fastest call */
+	uint32_t min;
+	/** clock cycles taken by the slowest call */
+	uint32_t max;
+} barelog_bench_result_t;
+
+/**
+ * Runs the benchmark on the calling core, whose logger must be initialized
+ * (see barelog_init_logger) and whose events must not be read by the host
+ * meanwhile. The events of the core (in the local buffer and in the shared
+ * memory) are discarded and its statistics account for the benchmark's events.
+ * The buffer policy given at initialization is restored at the end, while
+ * the memory policy is the one applied when the shared memory is full.
+ * @param config the configuration of the benchmark.
+ * @param results the array in which to store the results.
+ * @param max the size of the results array (BARELOG_BENCH_MAX_RESULTS to
+ * store all of them).
+ * @return the number of results stored, or an error code.
+ */
+extern int32_t barelog_bench_run(const barelog_bench_config_t *config,
+	barelog_bench_result_t *results, uint32_t max) __attribute__ ((cold));
+
+#endif /* __BARELOG_BENCH__ */
@@ -44,6 +44,10 @@
 #include "barelog_policy.h"
 #include "barelog_platform.h"
 
+/* Maximum number of pending asynchronous transfers (the records are copied
+ * by at most three contiguous runs). */
+#define BARELOG_TRANSFERS_MAX 3
+
 /**
  * Structure used to hold all of the barelog device manager functions.
  * We use pointers to allow the user to use the functions of their choice,
@@ -56,8 +60,21 @@ typedef struct {
 	uint32_t core;
 	/* Memory space associated to this manager/core */
 	barelog_mem_space_t mem_space;
+#if !BARELOG_WRITE_THROUGH_MODE
 	/* Events buffer associated to this manager/core */
 	barelog_event_buffer_t events;
+#endif
+	/* Head counter of the reserved record inside the events buffer
+	 * (or its index inside the shared memory in write-through mode) */
+	uint32_t reserved;
+	/* Is there a reserved (and not yet committed) record ? */
+	uint8_t reserving;
+	/* Timestamp of the last reserved record */
+	uint32_t timestamp;
+	/* Number of times the clock wrapped (see BARELOG_RECORD_EPOCH) */
+	uint32_t epoch;
+	/* Sequence number of the next event (see barelog_record_header_t) */
+	uint16_t sequence;
 	/* Shared memory part associated to this manager/core */
 	barelog_shared_mem_buffer_t shr_events;
 	/* policy to apply on the local events buffer */
@@ -78,6 +95,43 @@ typedef struct {
 	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
 	 */
 	int8_t (*write)(void * address, size_t size, const void *buffer);
+	/** (Optional) function used by the target to start an asynchronous
+	 * write into the shared memory (e.g. a DMA transfer).
+	 * @param address the address to write.
+	 * @param size the size of the memory to write.
+	 * @param buffer the buffer from which to write (must remain untouched
+	 * until the end of the transfer).
+	 * @param handle set to the handle of the started transfer.
+	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+	 */
+	int8_t (*write_async)(void * address, size_t size, const void *buffer,
+			uint32_t *handle);
+	/** Function used to know if an asynchronous write is over.
+	 * @param handle the handle of the transfer.
+	 * @return 1 if the transfer is over, 0 if not, an error code otherwise.
+	 */
+	int8_t (*poll)(uint32_t handle);
+	/** Function used to wait for the end of an asynchronous write.
+	 * @param handle the handle of the transfer.
+	 * @return BARELOG_SUCCESS if all is clear, an error code otherwise.
+	 */
+	int8_t (*wait)(uint32_t handle);
+	/* Handles of the pending asynchronous transfers */
+	uint32_t transfers[BARELOG_TRANSFERS_MAX];
+	/* Number of pending asynchronous transfers */
+	uint8_t nb_transfers;
+	/* Head counter of the oldest byte read by the pending transfers */
+	uint32_t transfer_tail;
+	/* Clock synchronization beacon of this core (in shared memory) */
+	barelog_sync_beacon_t *beacon;
+	/* Sequence number of the last synchronization request answered */
+	uint32_t sync_reply;
+	/* Statistics of this core (published into shared memory) */
+	barelog_core_stats_t stats;
+	/* Statistics of this core (in shared memory) */
+	barelog_core_stats_t *shr_stats;
+	/* Number of updates of the statistics since their last publication */
+	uint32_t stats_changes;
 #if BARELOG_DEBUG_MODE
 	/* Shared memory address to use if debug information are needed */
 	void *debug_address;
@@ -94,9 +148,12 @@ typedef struct {
  * @param memory_policy policy to use when the shared memory buffer is full.
  * @param read function used by device to read in shared memory.
  * @param write function used by device to write in shared memory.
- * @return BARELOG_NB_CORES on success, an error code in case of exception.
+ * The layout of the shared memory (number of cores, size of the rings...)
+ * is read from the header written by the host (see barelog_shared_header_t).
+ * @return the number of cores logged on success, an error code in case of
+ * exception (BARELOG_INIT_ERR if the header is missing or does not fit this core).
  **/
-extern int8_t device_mem_manager_init(const uint32_t core,
+extern int32_t device_mem_manager_init(const uint32_t core,
 		const barelog_platform_t platform,
 		const barelog_policy_t buffer_policy,
 		const barelog_policy_t memory_policy,
@@ -106,29 +163,97 @@ extern int8_t device_mem_manager_init(const uint32_t core,
 				const void *buffer)) __attribute__ ((cold));
 
 /**
- * Discards all current events in the calling core's local buffer.
+ * Discards all current events in the calling core's local buffer
+ * (does nothing in write-through mode).
  * @return BARELOG_SUCCESS on success or an error code in case of exception.
  */
 extern int8_t device_mem_manager_clean_buffer(void);
 
 /**
  * Discards the events from the oldest one to n further events
- * in the local buffer of the calling core.
- * @param n number of events to discard.
+ * in the local buffer of the calling core (does nothing in write-through mode).
+ * @param n number of events to discard (all the events are discarded if
+ * there are less than n events).
  * @return BARELOG_SUCCESS on success, an error code if an error occurs.
  */
 extern int8_t device_mem_manager_clean(uint32_t n);
 
 /**
  * Writes an event into the local event buffer of the calling core.
+ * Only the first length bytes of the event's data are stored.
  * @param event the event to write.
+ * @param length the length (in bytes) of the event's data.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_write_buffer(const barelog_event_t *event,
+		uint16_t length) __attribute__ ((hot));
+
+/**
+ * Reserves a record into the local event buffer of the calling core
+ * and gives direct access to its data, which avoids any copy of the event.
+ * The buffer policy is applied here if the buffer is full.
+ * The record is only added to the buffer by the following call to
+ * device_mem_manager_commit() : until then, it is neither flushed nor
+ * cleaned. Only one record can be reserved at a time, a new reservation
+ * discards the previous (uncommitted) one.
+ * In write-through mode, the record is directly reserved into the shared
+ * memory and the memory policy is applied instead of the buffer policy :
+ * data then points into the shared memory, which must be directly
+ * addressable by the core (see BARELOG_WRITE_THROUGH_MODE).
+ * A timestamp lower than the previous one means that the clock wrapped : an
+ * epoch marker record (see BARELOG_RECORD_EPOCH) is then stored first.
+ * Each event takes the next sequence number of the core, even if it is
+ * skipped or never committed, so that the host accounts for it as lost.
+ * @param timestamp the timestamp of the event.
+ * @param info the log-level of the event (0 if unknown) and the flags of
+ * the record (see barelog_record_header_t).
+ * @param size maximum size (in bytes) of the event's data (at most
+ * BARELOG_BUF_MAX_SIZE).
+ * @param data set to the address where to write the event's data, or
+ * to NULL if the event has to be skipped (see SKIP policy) or if an error
+ * occurred.
  * @return BARELOG_SUCCESS on success, an error code if an error occurs.
  */
-extern int8_t device_mem_manager_write_buffer(barelog_event_t event) __attribute__ ((hot));
+extern int8_t device_mem_manager_reserve(uint32_t timestamp, uint8_t info,
+		uint16_t size, void **data) __attribute__ ((hot));
+
+/**
+ * Returns the largest size of event's data which can be reserved without
+ * applying the buffer policy, e.g. to format an event directly into the
+ * room available and only apply the policy if it does not fit.
+ * In write-through mode, it is the room left in the shared ring (whose
+ * tail is read again from the shared memory if needed).
+ * @return the size (in bytes), at most BARELOG_BUF_MAX_SIZE, or 0 if the
+ * local buffer (or the shared ring) is full.
+ */
+extern uint16_t device_mem_manager_room(void) __attribute__ ((hot));
+
+/**
+ * Changes the size of the previously reserved record, applying the policy
+ * if needed (e.g. when the event's data turned out larger than the size
+ * reserved). The event keeps its timestamp and its sequence number, but the
+ * data already written into the record is lost.
+ * @see device_mem_manager_reserve
+ * @param size the new maximum size (in bytes) of the event's data (at most
+ * BARELOG_BUF_MAX_SIZE).
+ * @param data set to the address where to write the event's data, or
+ * to NULL if the event has to be skipped or if an error occurred.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_resize(uint16_t size, void **data);
+
+/**
+ * Commits the previously reserved record.
+ * @see device_mem_manager_reserve
+ * @param length the actual length (in bytes) of the event's data, which
+ * must be lower or equal to the reserved size.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_commit(uint16_t length) __attribute__ ((hot));
 
 /**
  * Flushes the local event buffer into the shared memory
- * section associated to the calling core.
+ * section associated to the calling core (does nothing in write-through mode).
  * @return BARELOG_SUCCESS on success, an error code if an error occurs.
  */
 extern int8_t device_mem_manager_flush_buffer(void);
@@ -136,12 +261,66 @@ extern int8_t device_mem_manager_flush_buffer(void);
 /**
  * Flushes all event contained in the calling core's event buffer
  * from the older one to n events further into the corresponding
- * shared memory section.
- * @param n number of events to flush.
+ * shared memory section. The events are not discarded from the local buffer.
+ * If they are skipped by the memory policy, they are accounted as dropped
+ * in the core's stats (on error, they are neither flushed nor accounted).
+ * Does nothing in write-through mode.
+ * @param n number of events to flush (all the events are flushed if
+ * there are less than n events).
  * @return BARELOG_SUCCESS on success, an error code if an error occurs.
  */
 extern int8_t device_mem_manager_flush(uint32_t n);
 
+/**
+ * Makes the flushes asynchronous : the records are then written into the
+ * shared memory using write_async and the core keeps logging meanwhile
+ * (the part of the local buffer being transferred is preserved until the
+ * end of the transfers). With the FLUSH policy, the local buffer is then
+ * flushed as soon as half of it is used, so that the events are logged into
+ * one half while the other one is transferred.
+ * Giving NULL functions makes the flushes synchronous again.
+ * @param write_async the function used to start an asynchronous write.
+ * @param poll the function used to know if an asynchronous write is over.
+ * @param wait the function used to wait for the end of an asynchronous write.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_set_async(
+		int8_t (*write_async)(void * address, size_t size,
+				const void *buffer, uint32_t *handle),
+		int8_t (*poll)(uint32_t handle),
+		int8_t (*wait)(uint32_t handle)) __attribute__ ((cold));
+
+/**
+ * Waits for the end of the pending asynchronous flush (if any).
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_wait_flush(void);
+
+/**
+ * Indicates whether or not the pending asynchronous flush (if any) is over.
+ * @return 1 if there is no pending flush, 0 otherwise.
+ */
+extern int8_t device_mem_manager_is_flush_done(void);
+
+/**
+ * Answers the pending clock synchronization request of the host (if any)
+ * with the current value of the clock (see barelog_sync_beacon_t). Between
+ * a reservation and its commit, the request is left pending (an epoch marker
+ * may have to be stored).
+ * @param get_clock the function used to retrieve the clock of the core.
+ * @return 1 if a request was answered, 0 if none was pending (or if a record
+ * is reserved), an error code otherwise.
+ */
+extern int8_t device_mem_manager_sync(uint32_t (*get_clock)(void));
+
+/**
+ * Publishes the statistics of the core (see barelog_core_stats_t) into the
+ * shared memory. They are otherwise published every BARELOG_STATS_PERIOD
+ * updates and when answering a clock synchronization request.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_publish_stats(void);
+
 /**
  * Erases all events in the shared memory buffer.
  * @return BARELOG_SUCCESS on success, an error code if something went wrong.
@@ -151,10 +330,31 @@ extern int8_t device_mem_manager_clean_memory(void);
 /**
  * Indicates whether or not the local events buffer is full (i.e we
  * can possibly override older events, depending on the used policy).
+ * In write-through mode, indicates whether or not the shared memory is full.
  * @return 1 if the buffer is full, 0 otherwise.
  */
 extern int8_t device_mem_manager_is_buffer_full(void);
 
+/**
+ * Changes the policy applied when the local events buffer is full
+ * (e.g. to compare the policies, see barelog_bench.h).
+ * @param policy the new buffer policy.
+ * @param previous (optional) set to the previous buffer policy.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_set_buffer_policy(barelog_policy_t policy,
+		barelog_policy_t *previous) __attribute__ ((cold));
+
+/**
+ * Returns the occupancy of the shared memory buffer of the calling core,
+ * that is to say the bytes of records neither consumed by the host nor
+ * overwritten yet (by whole chunks if a pool is used).
+ * @param used set to the number of bytes in use.
+ * @param size set to the size (in bytes) of the shared memory buffer.
+ * @return BARELOG_SUCCESS on success, an error code if an error occurs.
+ */
+extern int8_t device_mem_manager_occupancy(uint32_t *used, uint32_t *size);
+
 #if BARELOG_DEBUG_MODE
 /**
  * Internal function used for debugging purposes : writes the latest
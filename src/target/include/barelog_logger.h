@@ -64,7 +64,6 @@ typedef enum {
  * depending on the logged platform.
  */
 typedef struct {
-	barelog_lvl_t log_lvl;
 	/** Function used to retrieve the current clock of the core.
 	 * @return a timestamp on 32 bits.
 	 */
@@ -91,7 +90,8 @@ typedef struct {
  * @param get_clock the function used to retrieve timestamps.
  * @param init_clock the function used to initialize the target's clock.
  * @param start_clock the function used to start the target's clock.
- * @return BARELOG_SUCCESS on success.
+ * @return BARELOG_SUCCESS on success, an error code otherwise (BARELOG_INIT_ERR
+ * if the host has not described the shared memory yet, see host_mem_manager_init).
  */
 extern int8_t barelog_init_logger(const uint32_t my_core,
 		const barelog_platform_t platform,
@@ -117,6 +117,9 @@ extern int8_t barelog_start(void) __attribute__ ((cold));
  * If a real and functional get_clock() function was given upon initialization,
  * it will be used to automatically add a timestamp to the created event
  * containing the message.
+ * In binary mode, the event only carries the address of the format string
+ * (see barelog_set_format_resolver()); BARELOG_LOG stores a smaller id, which
+ * does not depend on the address the program was loaded at.
  *
  * @param lvl the log-level of the event.
  * @param format the event's data formatting string, followed, if needed, by
@@ -124,6 +127,104 @@ extern int8_t barelog_start(void) __attribute__ ((cold));
  */
 extern int8_t barelog_log(barelog_lvl_t lvl, const char *format, ...) __attribute__ ((hot));
 
+#if BARELOG_BINARY_MODE
+/**
+ * Logs an event whose format string is described by a log site. Only the
+ * (16 bits) id of the site and the arguments are stored into the event.
+ * Should not be called directly, use BARELOG_LOG instead.
+ *
+ * @param site the log site.
+ * @param format the format string of the site, followed, if needed, by
+ * the corresponding data values.
+ * @see BARELOG_LOG
+ */
+extern int8_t barelog_log_site(const barelog_site_t *site, const char *format, ...) __attribute__ ((hot));
+
+/* Expands to the first argument of a list of arguments. */
+#define BARELOG_FIRST_ARG(...) BARELOG_FIRST_ARG_(__VA_ARGS__, 0)
+#define BARELOG_FIRST_ARG_(first, ...) first
+
+/**
+ * Same as barelog_log but the format string (which must be a literal), the
+ * file, the line and the log-level of the call are stored once into the
+ * BARELOG_SITE_SECTION section of the target's program. The events then only
+ * hold the id of this site. The host retrieves the sites from the target's
+ * ELF (see host_sites_load).
+ * As barelog_log, it evaluates to the return code of the logging.
+ *
+ * @param level the log-level of the event.
+ * @param ... the event's data formatting string, followed, if needed, by
+ * the corresponding data values.
+ */
+#define BARELOG_LOG(level, ...) ({ \
+	static const barelog_site_t __barelog_site \
+		__attribute__ ((section(BARELOG_SITE_SECTION), used)) = { \
+		.format = BARELOG_FIRST_ARG(__VA_ARGS__), \
+		.file = __FILE__, \
+		.line = __LINE__, \
+		.lvl = (level) \
+	}; \
+	barelog_log_site(&__barelog_site, __VA_ARGS__); \
+})
+#else
+#define BARELOG_LOG(level, ...) barelog_log((level), __VA_ARGS__)
+#endif // BARELOG_BINARY_MODE
+
+/**
+ * Current log-level of the logger (events of higher levels are discarded).
+ * Should only be modified through barelog_set_log_lvl.
+ */
+extern barelog_lvl_t barelog_log_lvl;
+
+/* Logs an event through BARELOG_LOG if its level is enabled at runtime. */
+#define BARELOG_LOG_LVL_(level, ...) do { \
+	if ((level) <= barelog_log_lvl) { \
+		BARELOG_LOG((level), __VA_ARGS__); \
+	} \
+} while (0)
+
+/**
+ * Level-specific versions of BARELOG_LOG. Those whose level is above
+ * BARELOG_COMPILE_LVL expand to nothing (their arguments are not even
+ * evaluated), the other ones test the current log-level inline before
+ * calling the logging function.
+ * They are named after BARELOG_LOG rather than after the levels alone
+ * (BARELOG_INFO, ...) since BARELOG_DEBUG is already the internal debugging
+ * macro (see barelog_device_mem_manager.h).
+ * @param ... the event's data formatting string, followed, if needed, by
+ * the corresponding data values.
+ * @see BARELOG_LOG
+ */
+#if BARELOG_COMPILE_LVL >= 1
+#define BARELOG_LOG_CRITICAL(...) BARELOG_LOG_LVL_(BARELOG_CRITICAL_LVL, __VA_ARGS__)
+#else
+#define BARELOG_LOG_CRITICAL(...) do { } while (0)
+#endif
+
+#if BARELOG_COMPILE_LVL >= 2
+#define BARELOG_LOG_ERROR(...) BARELOG_LOG_LVL_(BARELOG_ERROR_LVL, __VA_ARGS__)
+#else
+#define BARELOG_LOG_ERROR(...) do { } while (0)
+#endif
+
+#if BARELOG_COMPILE_LVL >= 3
+#define BARELOG_LOG_WARNING(...) BARELOG_LOG_LVL_(BARELOG_WARNING_LVL, __VA_ARGS__)
+#else
+#define BARELOG_LOG_WARNING(...) do { } while (0)
+#endif
+
+#if BARELOG_COMPILE_LVL >= 4
+#define BARELOG_LOG_DEBUG(...) BARELOG_LOG_LVL_(BARELOG_DEBUG_LVL, __VA_ARGS__)
+#else
+#define BARELOG_LOG_DEBUG(...) do { } while (0)
+#endif
+
+#if BARELOG_COMPILE_LVL >= 5
+#define BARELOG_LOG_INFO(...) BARELOG_LOG_LVL_(BARELOG_INFO_LVL, __VA_ARGS__)
+#else
+#define BARELOG_LOG_INFO(...) do { } while (0)
+#endif
+
 /**
  * Does the same thing as barelog_log but flushes directly the
  * computed event and cleans the corresponding buffer.
@@ -131,6 +232,38 @@ extern int8_t barelog_log(barelog_lvl_t lvl, const char *format, ...) __attribut
  */
 extern int8_t barelog_immediate_log(barelog_lvl_t lvl, const char *format, ...) __attribute__ ((hot));
 
+/**
+ * Reserves an event of at most size bytes of data, timestamped with the
+ * current clock, and gives direct access to its data inside the local
+ * buffer. The event is logged by the following call to barelog_commit().
+ * @see device_mem_manager_reserve
+ * @param size maximum size (in bytes) of the event's data.
+ * @param data set to the address where to write the event's data (NULL if
+ * the event is skipped).
+ * @return BARELOG_SUCCESS on success, or an error code if something went wrong.
+ */
+extern int8_t barelog_reserve(uint16_t size, void **data) __attribute__ ((hot));
+
+/**
+ * @see device_mem_manager_commit
+ */
+#define barelog_commit(length) device_mem_manager_commit(length)
+
+/**
+ * Answers the pending clock synchronization request of the host, if any.
+ * It should be called regularly (e.g. in the main loop of the core) while the
+ * host estimates the offset and the drift of the core's clock.
+ * @see device_mem_manager_sync
+ * @return 1 if a request was answered, 0 if none was pending (or if a record
+ * is reserved), an error code otherwise.
+ */
+extern int8_t barelog_sync(void);
+
+/**
+ * @see device_mem_manager_publish_stats
+ */
+#define barelog_publish_stats() device_mem_manager_publish_stats()
+
 extern void barelog_set_log_lvl(barelog_lvl_t lvl);
 
 extern barelog_lvl_t barelog_get_log_lvl(void);
@@ -155,6 +288,22 @@ extern barelog_lvl_t barelog_get_log_lvl(void);
  */
 #define barelog_flush(n) device_mem_manager_flush(n)
 
+/**
+ * @see device_mem_manager_set_async
+ */
+#define barelog_set_async(write_async, poll, wait) \
+	device_mem_manager_set_async(write_async, poll, wait)
+
+/**
+ * @see device_mem_manager_wait_flush
+ */
+#define barelog_wait_flush() device_mem_manager_wait_flush()
+
+/**
+ * @see device_mem_manager_is_flush_done
+ */
+#define barelog_is_flush_done() device_mem_manager_is_flush_done()
+
 /**
  * @see device_mem_manager_is_buffer_full
  */
@@ -165,4 +314,15 @@ extern barelog_lvl_t barelog_get_log_lvl(void);
  */
 #define barelog_clean_memory() device_mem_manager_clean_memory()
 
+/**
+ * @see device_mem_manager_set_buffer_policy
+ */
+#define barelog_set_buffer_policy(policy, previous) \
+device_mem_manager_set_buffer_policy(policy, previous)
+
+/**
+ * @see device_mem_manager_occupancy
+ */
+#define barelog_occupancy(used, size) device_mem_manager_occupancy(used, size)
+
 #endif /* __BARELOG_LOGGER__ */
@@ -0,0 +1,251 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_bench.c
+ * @brief Command-line tool measuring the cost of the logging path of the target.
+ *
+ * usage : barelog-bench [options]
+ *
+ * Runs the benchmark of the target (see barelog_bench.h) on a simulated core
+ * (see linux_sim/barelog_sim.h) and prints its results as JSON, along with
+ * the size of the code of the functions measured. The instructions are
+ * counted by the hardware counters of Linux (perf_event_open()) if available.
+ * Only built with 'make PLATFORM=linux_sim'.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#define _GNU_SOURCE // syscall()
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+
+#include "barelog_host.h"
+#include "barelog_bench.h"
+#include "barelog_sim.h"
+
+static const char *const apis[BARELOG_BENCH_NB_APIS] = {
+	"barelog_log", "device_mem_manager_write_buffer",
+	"device_mem_manager_flush", "device_mem_manager_clean"
+};
+
+static const char *const patterns[BARELOG_BENCH_NB_PATTERNS] = {
+	"no_args", "ints", "strings", "mixed"
+};
+
+static const char *const policies[] = { "skip", "replace", "flush", "destroy" };
+
+/* Functions whose code size is reported : the ones measured and the ones
+ * they call on the logging path. */
+static const char *const functions[] = {
+	"barelog_log", "device_mem_manager_reserve", "device_mem_manager_commit",
+	"device_mem_manager_write_buffer", "device_mem_manager_flush",
+	"device_mem_manager_clean", "portable_vsnprintf"
+};
+
+static struct {
+	uint32_t iterations;
+	uint32_t ring_size;
+	barelog_policy_t memory_policy;
+	uint32_t (*get_clock)(void);
+	const char *clock;
+	const char *elf;
+	/* Counter of the instructions (-1 if not available). */
+	int perf;
+} bench = {
+	.iterations = 1000,
+	.ring_size = 65536,
+	.memory_policy = SKIP,
+	.get_clock = linux_sim_clock_tsc,
+	.clock = "tsc",
+	.elf = "/proc/self/exe",
+	.perf = -1
+};
+
+static barelog_bench_result_t results[BARELOG_BENCH_MAX_RESULTS];
+
+static void usage(FILE *stream) {
+	fprintf(stream,
+		"usage : barelog-bench [options]\n"
+		"  -n calls    number of measured calls of each function (1000 by default)\n"
+		"  -r size     size (in bytes) of the ring of the core (65536 by default)\n"
+		"  -m policy   memory policy : skip (default), replace or destroy\n"
+		"  -c clock    clock of the core : tsc (default) or ns\n"
+		"  -e elf      program whose code size is reported (this one by default)\n"
+		"  -h          print this help\n");
+}
+
+static uint32_t get_instructions(void) {
+	uint64_t count = 0;
+	if (read(bench.perf, &count, sizeof(count)) != sizeof(count)) {
+		return 0;
+	}
+	return (uint32_t) count;
+}
+
+/* Opens the counter of the instructions executed in user mode by this process. */
+static int open_perf(void) {
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void print_results(uint32_t n) {
+	printf("{\n  \"clock\": \"%s\",\n  \"clock_rate\": %" PRIu64 ",\n"
+		"  \"iterations\": %" PRIu32 ",\n  \"memory_policy\": \"%s\",\n"
+		"  \"ring_size\": %" PRIu32 ",\n  \"local_buffer_size\": %u,\n"
+		"  \"instructions\": %s,\n  \"code_size\": {",
+		bench.clock, linux_sim_clock_rate(bench.get_clock), bench.iterations,
+		policies[bench.memory_policy], bench.ring_size, BARELOG_LOCAL_BUFFER_SIZE,
+		(bench.perf >= 0) ? "true" : "false");
+	for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); ++i) {
+		printf("%s\"%s\": %" PRId32, (i) ? ", " : "", functions[i],
+			barelog_host_symbol_size(bench.elf, functions[i]));
+	}
+	printf("},\n  \"results\": [\n");
+
+	for (uint32_t i = 0; i < n; ++i) {
+		const barelog_bench_result_t *result = &(results[i]);
+		const double calls = (result->calls) ? result->calls : 1;
+		printf("    {\"api\": \"%s\", ", apis[result->api]);
+		if (result->api == BARELOG_BENCH_LOG) {
+			printf("\"pattern\": \"%s\", ", patterns[result->pattern]);
+		}
+		printf("\"buffer_policy\": \"%s\", \"occupancy\": %" PRIu32 ", \"calls\": %" PRIu32
+			", \"errors\": %" PRIu32 ", \"cycles\": %.1f, \"min\": %" PRIu32
+			", \"max\": %" PRIu32 ", \"instructions\": ",
+			policies[result->buffer_policy], result->occupancy, result->calls,
+			result->errors, result->cycles / calls, result->min, result->max);
+		if (bench.perf >= 0) {
+			printf("%.1f}", result->instructions / calls);
+		} else {
+			printf("null}");
+		}
+		printf("%s\n", (i + 1 < n) ? "," : "");
+	}
+	printf("  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+	int opt;
+	barelog_platform_t platform;
+
+	while ((opt = getopt(argc, argv, "n:r:m:c:e:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			bench.iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			bench.ring_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			if (!strcmp(optarg, "skip")) {
+				bench.memory_policy = SKIP;
+			} else if (!strcmp(optarg, "replace")) {
+				bench.memory_policy = REPLACE;
+			} else if (!strcmp(optarg, "destroy")) {
+				bench.memory_policy = DESTROY;
+			} else {
+				fprintf(stderr, "barelog-bench : invalid policy %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'c':
+			if (!strcmp(optarg, "tsc")) {
+				bench.get_clock = linux_sim_clock_tsc;
+			} else if (!strcmp(optarg, "ns")) {
+				bench.get_clock = linux_sim_clock_ns;
+			} else {
+				fprintf(stderr, "barelog-bench : invalid clock %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			bench.clock = optarg;
+			break;
+		case 'e':
+			bench.elf = optarg;
+			break;
+		case 'h':
+			usage(stdout);
+			return EXIT_SUCCESS;
+		default:
+			usage(stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind != argc || !bench.iterations) {
+		usage(stderr);
+		return EXIT_FAILURE;
+	}
+
+	/* A single core, logging from this process. */
+	if (linux_sim_open(NULL, BARELOG_SHARED_MEM_MAX + bench.ring_size, &platform) != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-bench : cannot create the shared memory\n");
+		return EXIT_FAILURE;
+	}
+	if (barelog_set_geometry(1, bench.ring_size, 0) != BARELOG_SUCCESS
+		|| barelog_host_init(platform, linux_sim_mem_init, linux_sim_mem_read,
+			linux_sim_mem_write, linux_sim_mem_finalize) != 1
+		|| barelog_init_logger(0, platform, FLUSH, bench.memory_policy,
+			linux_sim_mem_read, linux_sim_mem_write, bench.get_clock,
+			linux_sim_init_clock, linux_sim_start_clock) != BARELOG_SUCCESS
+		|| barelog_start() != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-bench : invalid ring size %" PRIu32 "\n", bench.ring_size);
+		return EXIT_FAILURE;
+	}
+
+	bench.perf = open_perf();
+	const barelog_bench_config_t config = {
+		.iterations = bench.iterations,
+		.get_clock = bench.get_clock,
+		.get_instructions = (bench.perf >= 0) ? get_instructions : NULL
+	};
+	const int32_t n = barelog_bench_run(&config, results, BARELOG_BENCH_MAX_RESULTS);
+	if (n < 0) {
+		fprintf(stderr, "barelog-bench : benchmark error %" PRId32 "\n", n);
+		return EXIT_FAILURE;
+	}
+	print_results(n);
+
+	if (bench.perf >= 0) {
+		close(bench.perf);
+	}
+	barelog_host_finalize();
+	linux_sim_close(NULL, &platform);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,380 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_cat.c
+ * @brief Command-line tool printing the events of trace files.
+ *
+ * usage : barelog-cat [options] trace...
+ *
+ * The events of the traces (see barelog_host_trace.h) are printed in the
+ * order of the files, filtered by core, time range, log-level and text.
+ * Only the chunks of the traces whose index matches the cores and the time
+ * range asked for are read.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#define _POSIX_C_SOURCE 200809L // getopt
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "barelog_host.h"
+
+/* Number of events read at once from a trace. */
+#define BARELOG_CAT_BATCH 1024
+
+typedef enum {
+	FORMAT_TEXT,
+	FORMAT_CSV,
+	FORMAT_JSON
+} cat_format_t;
+
+static struct {
+	/* Cores whose events are printed (mask of the chunks and exact set). */
+	uint64_t mask;
+	uint8_t cores[1 << 16];
+	const char *from;
+	const char *to;
+	/* Highest log-level printed, -1 for all. */
+	int32_t level;
+	const char *text;
+	cat_format_t format;
+	/* Are the statistics of the cores printed instead of the events ? */
+	uint8_t stats;
+} cat = {
+	.mask = UINT64_MAX,
+	.level = -1,
+	.format = FORMAT_TEXT
+};
+
+static barelog_event_t events[BARELOG_CAT_BATCH];
+
+static void usage(FILE *stream) {
+	fprintf(stream,
+		"usage : barelog-cat [options] trace...\n"
+		"  -c cores   cores to print (e.g. 0,3,7-9), all by default\n"
+		"  -f time    print the events logged from time on\n"
+		"  -t time    print the events logged until time\n"
+		"             (in timestamp units, or suffixed by s, ms, us or ns if\n"
+		"              the clock rate of the trace is known)\n"
+		"  -l level   highest log-level to print (1 : critical ... 5 : info),\n"
+		"             the events whose level is unknown being printed\n"
+		"  -s text    print the events containing text only\n"
+		"  -o format  output format : text (default), csv or json (one object per line)\n"
+		"  -e elf     target's program holding the log sites (binary mode)\n"
+		"  -S         print the statistics of the cores (events dropped,\n"
+		"             overwritten and flushed) instead of the events\n"
+		"  -h         print this help\n");
+}
+
+/* Parses a set of cores such as 0,3,7-9. */
+static int parse_cores(const char *arg) {
+	char *end;
+
+	memset(cat.cores, 0, sizeof(cat.cores));
+	cat.mask = 0;
+	while (*arg) {
+		const unsigned long first = strtoul(arg, &end, 10);
+		unsigned long last = first;
+		if (end == arg) {
+			return -1;
+		}
+		if (*end == '-') {
+			arg = end + 1;
+			last = strtoul(arg, &end, 10);
+			if (end == arg) {
+				return -1;
+			}
+		}
+		if (first > last || last >= sizeof(cat.cores)) {
+			return -1;
+		}
+		for (unsigned long core = first; core <= last; ++core) {
+			cat.cores[core] = 1;
+			cat.mask |= UINT64_C(1) << (core % 64);
+		}
+		if (*end == ',') {
+			++end;
+		} else if (*end) {
+			return -1;
+		}
+		arg = end;
+	}
+
+	return 0;
+}
+
+/* Converts a time into timestamp units. */
+static int parse_time(const char *arg, uint64_t clock_rate, uint64_t *timestamp) {
+	static const struct {
+		const char *suffix;
+		double scale;
+	} units[] = { { "s", 1 }, { "ms", 1e-3 }, { "us", 1e-6 }, { "ns", 1e-9 } };
+	char *end;
+
+	const double value = strtod(arg, &end);
+	if (end == arg || value < 0) {
+		return -1;
+	}
+	if (!*end) {
+		*timestamp = value;
+		return 0;
+	}
+	for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); ++i) {
+		if (!strcmp(end, units[i].suffix)) {
+			if (!clock_rate) {
+				return -1;
+			}
+			*timestamp = value * units[i].scale * clock_rate;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/* Returns the log-level of an event, -1 if unknown (e.g. the events
+ * reserved through barelog_reserve), falling back on its log site. */
+static int32_t event_level(const barelog_event_t *event) {
+	if (event->level) {
+		return event->level;
+	}
+#if BARELOG_BINARY_MODE
+	if ((uint8_t) event->data[0] == BARELOG_BINARY_SITE_TAG) {
+		uint16_t site_id;
+		memcpy(&site_id, &(event->data[1]), sizeof(site_id));
+		const barelog_site_t *site = host_sites_get(event->core, site_id);
+		return (site != NULL) ? (int32_t) site->lvl : -1;
+	}
+#endif
+	return -1;
+}
+
+static void print_escaped(const char *text, cat_format_t format) {
+	for (; *text; ++text) {
+		const unsigned char c = *text;
+		if (format == FORMAT_CSV) {
+			if (c == '"') {
+				putchar('"');
+			}
+			putchar(c);
+		} else if (c == '"' || c == '\\') {
+			putchar('\\');
+			putchar(c);
+		} else if (c < 0x20) {
+			printf("\\u%04x", c);
+		} else {
+			putchar(c);
+		}
+	}
+}
+
+/* Returns the message of an event, following its timestamp and its core in its line. */
+static const char *line_message(const char *line) {
+	const char *message = strchr(line, ' ');
+	message = (message != NULL) ? strchr(message + 1, ' ') : NULL;
+	return (message != NULL) ? message + 1 : "";
+}
+
+static void print_event(const barelog_event_t *event, const char *line, const char *message) {
+	switch (cat.format) {
+	case FORMAT_TEXT:
+		puts(line);
+		break;
+	case FORMAT_CSV:
+		printf("%"PRIu64",%"PRIu32",\"", event->timestamp, event->core);
+		print_escaped(message, FORMAT_CSV);
+		puts("\"");
+		break;
+	case FORMAT_JSON:
+		printf("{\"timestamp\":%"PRIu64",\"core\":%"PRIu32",\"message\":\"", event->timestamp, event->core);
+		print_escaped(message, FORMAT_JSON);
+		puts("\"}");
+		break;
+	}
+}
+
+/* Prints the statistics of the cores stored in a trace. */
+static void print_stats(const char *path, const barelog_trace_t *trace) {
+	if (trace->stats == NULL) {
+		fprintf(stderr, "barelog-cat : %s holds no statistics\n", path);
+		return;
+	}
+	for (uint32_t core = 0; core < trace->nb_stats; ++core) {
+		const barelog_core_stats_t *stats = &(trace->stats[core]);
+		if (!cat.cores[core & 0xffff]) {
+			continue;
+		}
+		switch (cat.format) {
+		case FORMAT_CSV:
+			printf("%"PRIu32",%"PRIu32",%"PRIu32",%"PRIu32",%"PRIu32"\n", core,
+				stats->dropped, stats->overwritten, stats->flushed, stats->bytes);
+			break;
+		case FORMAT_JSON:
+			printf("{\"core\":%"PRIu32",\"dropped\":%"PRIu32",\"overwritten\":%"PRIu32
+				",\"flushed\":%"PRIu32",\"bytes\":%"PRIu32"}\n", core,
+				stats->dropped, stats->overwritten, stats->flushed, stats->bytes);
+			break;
+		default:
+			printf("core %"PRIu32" : %"PRIu32" dropped, %"PRIu32" overwritten, %"PRIu32
+				" flushed (%"PRIu32" bytes)\n", core,
+				stats->dropped, stats->overwritten, stats->flushed, stats->bytes);
+			break;
+		}
+	}
+}
+
+static int cat_trace(const char *path) {
+	barelog_trace_t trace;
+	barelog_trace_iter_t iter;
+	uint64_t from = 0;
+	uint64_t to = UINT64_MAX;
+	char line[EVENT_TO_STRING_SIZE];
+	int32_t n;
+
+	if (barelog_trace_open(path, &trace) != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-cat : cannot read the trace %s\n", path);
+		return -1;
+	}
+	if (!(trace.header->flags & BARELOG_TRACE_BINARY) != !BARELOG_BINARY_MODE) {
+		fprintf(stderr, "barelog-cat : %s was logged %s the binary mode\n", path,
+			(trace.header->flags & BARELOG_TRACE_BINARY) ? "with" : "without");
+		barelog_trace_close(&trace);
+		return -1;
+	}
+	if ((cat.from != NULL && parse_time(cat.from, trace.header->clock_rate, &from))
+		|| (cat.to != NULL && parse_time(cat.to, trace.header->clock_rate, &to))) {
+		fprintf(stderr, "barelog-cat : invalid time range for %s\n", path);
+		barelog_trace_close(&trace);
+		return -1;
+	}
+
+	if (cat.stats) {
+		print_stats(path, &trace);
+	} else if (from <= to && barelog_trace_seek(&trace, from, to, &iter) == BARELOG_SUCCESS) {
+		iter.cores = cat.mask;
+		while ((n = barelog_trace_read(&iter, events, BARELOG_CAT_BATCH)) > 0) {
+			for (int32_t i = 0; i < n; ++i) {
+				const barelog_event_t *event = &(events[i]);
+				if (!cat.cores[event->core & 0xffff]) {
+					continue;
+				}
+				if (cat.level >= 0) {
+					const int32_t level = event_level(event);
+					if (level > cat.level) {
+						continue;
+					}
+				}
+				if (barelog_event_to_string(*event, line) < 0) {
+					continue;
+				}
+				const char *message = line_message(line);
+				if (cat.text != NULL && strstr(message, cat.text) == NULL) {
+					continue;
+				}
+				print_event(event, line, message);
+			}
+		}
+	}
+	barelog_trace_close(&trace);
+
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	int opt;
+	int ret = EXIT_SUCCESS;
+
+	memset(cat.cores, 1, sizeof(cat.cores));
+	while ((opt = getopt(argc, argv, "c:f:t:l:s:o:e:Sh")) != -1) {
+		switch (opt) {
+		case 'c':
+			if (parse_cores(optarg)) {
+				fprintf(stderr, "barelog-cat : invalid cores %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'f':
+			cat.from = optarg;
+			break;
+		case 't':
+			cat.to = optarg;
+			break;
+		case 'l':
+			cat.level = atoi(optarg);
+			break;
+		case 's':
+			cat.text = optarg;
+			break;
+		case 'o':
+			if (!strcmp(optarg, "text")) {
+				cat.format = FORMAT_TEXT;
+			} else if (!strcmp(optarg, "csv")) {
+				cat.format = FORMAT_CSV;
+			} else if (!strcmp(optarg, "json")) {
+				cat.format = FORMAT_JSON;
+			} else {
+				fprintf(stderr, "barelog-cat : invalid format %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'e':
+			if (barelog_host_load_sites(optarg) < 0) {
+				fprintf(stderr, "barelog-cat : cannot load the log sites of %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'S':
+			cat.stats = 1;
+			break;
+		case 'h':
+			usage(stdout);
+			return EXIT_SUCCESS;
+		default:
+			usage(stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind == argc) {
+		usage(stderr);
+		return EXIT_FAILURE;
+	}
+
+	if (cat.format == FORMAT_CSV) {
+		puts((cat.stats) ? "core,dropped,overwritten,flushed,bytes" : "timestamp,core,message");
+	}
+	for (int i = optind; i < argc; ++i) {
+		if (cat_trace(argv[i])) {
+			ret = EXIT_FAILURE;
+		}
+	}
+
+	return ret;
+}
@@ -0,0 +1,113 @@
+#!/bin/sh
+# The MIT License (MIT)
+#
+# Copyright (c) 2026 The barelog contributors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Regression tests of the whole pipeline on the simulated cores, run by
+# 'make PLATFORM=linux_sim check' (the tools being in the directory given as
+# argument) :
+#  - barelog-sim with every buffer and memory policy, fixed rings or a pool of
+#    chunks, synchronous or asynchronous flushes : each event logged has to be
+#    drained or counted as lost by its core (see tools/barelog_sim.c) ;
+#  - the merge of the timelines of more than 64 cores, and the events
+#    identified by the address of their format (binary mode) ;
+#  - a ring filled before being drained (memory policy skip) : the small
+#    events have to fill it up to its end ;
+#  - traces written by barelog-sim (plain or compressed, drained by threads or
+#    merged) and read back by barelog-cat : all the events logged have to be
+#    read back, in the order of their logging (and of their timestamps once
+#    merged).
+
+BINDIR=${1:-../bin}
+SIM="$BINDIR/barelog-sim"
+CAT="$BINDIR/barelog-cat"
+TMP=$(mktemp -d) || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+CORES=4
+EVENTS=5000
+failures=0
+
+check() {
+	if "$@" > "$TMP/output" 2>&1; then
+		echo "ok      $*"
+	else
+		echo "FAILED  $*"
+		cat "$TMP/output"
+		failures=$((failures + 1))
+	fi
+}
+
+# Writes a trace with barelog-sim and reads it back with barelog-cat.
+roundtrip() {
+	rm -f "$TMP"/trace.*
+	"$SIM" -n $CORES -e $EVENTS -w "$TMP/trace" -j "$@" > "$TMP/sim.json" || return 1
+	written=$(sed -n 's/.*"written": \([0-9]*\).*/\1/p' "$TMP/sim.json")
+	[ "$written" -eq $((CORES * EVENTS)) ] || return 1
+	"$CAT" -e "$SIM" "$TMP"/trace.*.blseg > "$TMP/events" || return 1
+	# <timestamp> <core> core <core> event <index>
+	awk -v cores=$CORES -v events=$EVENTS -v merged=$(case "$*" in *-M*) echo 1;; *) echo 0;; esac) '
+		$4 != $2 || $6 != next_index[$2] + 0 { bad++ }
+		merged && $1 < timestamp { bad++ }
+		{ next_index[$2] = $6 + 1; timestamp = $1 }
+		END {
+			for (core in next_index) {
+				if (next_index[core] != events) bad++
+				seen++
+			}
+			exit (bad || seen != cores)
+		}' "$TMP/events"
+}
+
+# A core fills its ring while the host sleeps : the events are only skipped
+# once less room than a record is left (the ring bytes being the drained ones).
+filled() {
+	"$SIM" -n 1 -e 1000 -r 4096 -m skip -f 1 -p 1000000 -j > "$TMP/sim.json" || return 1
+	bytes=$(sed -n 's/.*"bytes": \([0-9]*\).*/\1/p' "$TMP/sim.json")
+	[ $((4096 - bytes)) -lt 32 ]
+}
+
+for buffer in skip replace flush destroy; do
+	for memory in skip replace destroy; do
+		for async in "" "-a"; do
+			check "$SIM" -n 8 -r 4096 -e 20000 -H 2 -b $buffer -m $memory $async
+			check "$SIM" -n 8 -r 16384 -k 4096 -e 20000 -H 2 -b $buffer -m $memory $async
+		done
+	done
+done
+
+# The merge of more cores than the bits of a 64 bits mask.
+check "$SIM" -n 100 -e 2000 -M
+
+# Both kinds of format ids (binary mode).
+check "$SIM" -n 8 -e 20000 -F
+
+check filled
+
+for options in "" "-z" "-a" "-M" "-M -z"; do
+	check roundtrip $options
+done
+
+if [ $failures -ne 0 ]; then
+	echo "$failures check(s) failed"
+	exit 1
+fi
+echo "all checks passed"
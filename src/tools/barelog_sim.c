@@ -0,0 +1,518 @@
+/* The MIT License (MIT)
+
+ Copyright (c) 2026 The barelog contributors
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+*/
+
+/**
+ * @file barelog_sim.c
+ * @brief Command-line tool running the whole logging pipeline on Linux.
+ *
+ * usage : barelog-sim [options]
+ *
+ * Simulated cores (see linux_sim/barelog_sim.h) log events into the shared
+ * memory while the host drains them with a pool of threads (or merges their
+ * timelines, see barelog_host_merge.h), optionally storing them into trace
+ * files. The events drained are checked, as well as
+ * their count against the events lost reported by the cores, and the
+ * throughput is reported, so that the pipeline can be benchmarked, profiled
+ * and regression-tested with any number of cores (the exit status being 1
+ * if a check failed). Only built with 'make PLATFORM=linux_sim'.
+ *
+ * @author The barelog contributors
+ * @date 17/10/2026
+ */
+
+#define _POSIX_C_SOURCE 200809L // getopt
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "barelog_host.h"
+#include "barelog_host_sites.h"
+#include "barelog_logger.h"
+#include "barelog_sim.h"
+
+static const char *const policies[] = { "skip", "replace", "flush", "destroy" };
+
+static struct {
+	uint32_t nb_cores;
+	uint32_t events;
+	uint32_t ring_size;
+	uint32_t chunk_size;
+	barelog_policy_t buffer_policy;
+	barelog_policy_t memory_policy;
+	/* Number of events between two flushes of the cores, 0 to only rely
+	 * on the buffer policy. */
+	uint32_t flush_period;
+	/* Number of cores logging all their events, the others only logging
+	 * one event out of 100 (0 for all of them). */
+	uint32_t hot;
+	/* Flushes through the fake DMA engine of the cores (see linux_sim_dma_write). */
+	uint8_t async;
+	/* Drains the cores through the merge of their timelines instead of
+	 * the drain threads. */
+	uint8_t merge;
+	/* The odd cores log through barelog_log instead of BARELOG_LOG (their
+	 * events being identified by the address of their format in binary
+	 * mode, which barelog-cat cannot resolve). */
+	uint8_t format_ids;
+	uint32_t nb_threads;
+	uint32_t period;
+	const char *prefix;
+	/* Compresses the blocks of the trace files (see barelog_host_codec.h). */
+	uint8_t compress;
+	const char *shm;
+	uint32_t (*get_clock)(void);
+	uint8_t json;
+	barelog_platform_t platform;
+} sim = {
+	.nb_cores = 16,
+	.events = 100000,
+	.buffer_policy = FLUSH,
+	.memory_policy = SKIP,
+	.nb_threads = 1,
+	.period = 100,
+	.get_clock = linux_sim_clock_ns
+};
+
+/* Checks of the events drained from each core (only updated by the drain
+ * thread of the core). */
+static struct {
+	uint64_t events;
+	/* Events whose core, index or sequence number is wrong. */
+	uint64_t bad;
+	uint32_t index;
+} checks[BARELOG_NB_CORES];
+
+static void usage(FILE *stream) {
+	fprintf(stream,
+		"usage : barelog-sim [options]\n"
+		"  -n cores    number of simulated cores (16 by default)\n"
+		"  -e events   number of events logged by each core (100000 by default)\n"
+		"  -r size     size (in bytes) of the ring of each core\n"
+		"  -k size     size (in bytes) of the chunks of the pool (0 for fixed rings)\n"
+		"  -b policy   buffer policy : skip, replace, flush (default) or destroy\n"
+		"  -m policy   memory policy : skip (default), replace or destroy\n"
+		"  -f n        flush the cores every n events (0 to rely on the buffer policy)\n"
+		"  -H n        the first n cores log all their events, the others only 1%%\n"
+		"  -a          flush asynchronously through a fake DMA engine per core\n"
+		"  -F          the odd cores log through barelog_log instead of BARELOG_LOG\n"
+		"  -t n        number of drain threads (1 by default)\n"
+		"  -M          drain through the merge of the timelines of the cores,\n"
+		"              checking the order of the events\n"
+		"  -p us       sleep of the drain threads between idle sweeps (100 by default)\n"
+		"  -w prefix   store the events into trace files <prefix>.<index>.blseg\n"
+		"  -z          compress the blocks of the trace files\n"
+		"  -c clock    clock of the cores : ns (default) or tsc\n"
+		"  -s name     name of the POSIX shared memory object (anonymous by default)\n"
+		"  -j          print the results as JSON\n"
+		"  -h          print this help\n");
+}
+
+static int parse_policy(const char *arg, barelog_policy_t *policy) {
+	for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+		if (!strcmp(arg, policies[i])) {
+			*policy = (barelog_policy_t) i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static inline uint32_t core_events(uint32_t core) {
+	return (!sim.hot || core < sim.hot) ? sim.events : sim.events / 100;
+}
+
+/* Flushes the events of the core (waiting for the transfers if asked). */
+static int8_t core_flush(uint8_t wait) {
+	int8_t ret = barelog_flush_buffer();
+
+	if (ret >= 0) {
+		ret = barelog_clean_buffer();
+	}
+	if (ret >= 0 && wait) {
+		ret = barelog_wait_flush();
+	}
+	return ret;
+}
+
+static int core_main(uint32_t core, void *arg) {
+	(void) arg;
+	const uint32_t n = core_events(core);
+	int8_t ret = BARELOG_SUCCESS;
+
+	if (barelog_init_logger(core, sim.platform, sim.buffer_policy, sim.memory_policy,
+		linux_sim_mem_read, linux_sim_mem_write, sim.get_clock,
+		linux_sim_init_clock, linux_sim_start_clock) != BARELOG_SUCCESS
+		|| barelog_start() != BARELOG_SUCCESS) {
+		return EXIT_FAILURE;
+	}
+	if (sim.async && barelog_set_async(linux_sim_dma_write, linux_sim_dma_poll,
+		linux_sim_dma_wait) != BARELOG_SUCCESS) {
+		return EXIT_FAILURE;
+	}
+
+	/* In binary mode, the events are logged through their log site, or
+	 * through the address of their format (see sim.format_ids). */
+	for (uint32_t i = 0; i < n && ret >= 0; ++i) {
+		ret = (sim.format_ids && (core & 1)) ? barelog_log(BARELOG_INFO_LVL, "core %u event %u", core, i)
+			: BARELOG_LOG(BARELOG_INFO_LVL, "core %u event %u", core, i);
+		if (ret >= 0 && sim.flush_period && (i + 1) % sim.flush_period == 0) {
+			ret = core_flush(0);
+		}
+	}
+	/* The last records are only published at the end of their transfers. */
+	if (ret < 0 || core_flush(1) < 0 || barelog_publish_stats() < 0) {
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/* Checks an event against the previous one of its core. */
+static uint8_t check_event(uint32_t core, const barelog_event_t *event) {
+	const uint8_t first = !checks[core].events;
+	const char *data = event->data;
+
+	++checks[core].events;
+	if (event->core != core) {
+		return 0;
+	}
+#if BARELOG_BINARY_MODE
+	/* The events are formatted with their log site, after the timestamp
+	 * and the core. */
+	char line[EVENT_TO_STRING_SIZE];
+	if (barelog_event_to_string(*event, line) != BARELOG_SUCCESS
+		|| (data = strchr(line, ' ')) == NULL || (data = strchr(data + 1, ' ')) == NULL) {
+		return 0;
+	}
+	++data;
+#endif
+	/* The events hold the index of their logging (see core_main). */
+	char *end;
+	if (strncmp(data, "core ", 5) || strtoul(data + 5, &end, 10) != core
+		|| strncmp(end, " event ", 7)) {
+		return 0;
+	}
+	const uint32_t index = strtoul(end + 7, NULL, 10);
+	const uint8_t ordered = first || index > checks[core].index;
+	checks[core].index = index;
+	return ordered && event->sequence == (uint16_t) index;
+}
+
+static void consume(const barelog_drain_batch_t *batch, void *arg) {
+	(void) arg;
+
+	for (uint32_t i = 0; i < batch->length; ++i) {
+		if (!check_event(batch->core, &(batch->events[i]))) {
+			++checks[batch->core].bad;
+		}
+	}
+	if (sim.prefix != NULL) {
+		host_writer_consume(batch, NULL);
+	}
+}
+
+/* Drains the cores through the merge of their timelines until they are all
+ * done, the events being consumed as if they were drained by a single thread
+ * (by batches of consecutive events of the same core). */
+static int8_t merge(barelog_drain_stats_t *drain) {
+	static barelog_event_t events[BARELOG_DRAIN_BATCH];
+	const struct timespec period = { .tv_sec = 0, .tv_nsec = sim.period * 1000 };
+	uint64_t timestamp = 0;
+	uint8_t done = 0;
+	int32_t n;
+
+	memset(drain, 0, sizeof(barelog_drain_stats_t));
+	do {
+		/* Once the cores are done, the last events are all emitted. */
+		done = (linux_sim_running() <= 0);
+		while ((n = barelog_merge_read(events, BARELOG_DRAIN_BATCH, done)) > 0) {
+			for (int32_t i = 0; i < n;) {
+				barelog_drain_batch_t batch = { .core = events[i].core, .events = &(events[i]) };
+				for (; i < n && events[i].core == batch.core; ++i, ++batch.length) {
+					if (events[i].timestamp < timestamp) {
+						++checks[batch.core].bad;
+					}
+					timestamp = events[i].timestamp;
+				}
+				consume(&batch, NULL);
+			}
+			drain->events += n;
+		}
+		if (n < 0) {
+			return (int8_t) n;
+		}
+		if (!done) {
+			nanosleep(&period, NULL);
+		}
+	} while (!done);
+
+	return BARELOG_SUCCESS;
+}
+
+#if BARELOG_BINARY_MODE
+/* The simulated cores being forks of this program, the addresses of their
+ * formats are valid here. */
+static const char *resolve_format(uint32_t core, uint64_t format_id) {
+	(void) core;
+	return (const char *) (uintptr_t) format_id;
+}
+#endif
+
+static double elapsed(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static int run(void) {
+	struct timespec start;
+	barelog_drain_stats_t drain;
+	barelog_writer_stats_t writer = { 0 };
+	uint64_t logged = 0, bad = 0, dropped = 0, overwritten = 0, flushed = 0;
+	const struct timespec period = { .tv_sec = 0, .tv_nsec = 1000000 };
+	int32_t failed;
+	int8_t merged = BARELOG_SUCCESS;
+
+#if BARELOG_BINARY_MODE
+	/* The simulated cores run this program : its log sites are theirs. */
+	if (barelog_host_load_sites("/proc/self/exe") < 0) {
+		fprintf(stderr, "barelog-sim : cannot load the log sites\n");
+		return EXIT_FAILURE;
+	}
+	barelog_set_format_resolver(resolve_format);
+#endif
+	if (barelog_set_geometry(sim.nb_cores, sim.ring_size, sim.chunk_size) != BARELOG_SUCCESS
+		|| barelog_host_init(sim.platform, linux_sim_mem_init, linux_sim_mem_read,
+			linux_sim_mem_write, linux_sim_mem_finalize) != (int32_t) sim.nb_cores) {
+		fprintf(stderr, "barelog-sim : invalid geometry\n");
+		return EXIT_FAILURE;
+	}
+	if (sim.prefix != NULL) {
+		const barelog_writer_config_t config = {
+			.prefix = sim.prefix,
+			.segment_size = 64 << 20,
+			.nb_producers = sim.nb_threads,
+			.queue_size = 1 << 20,
+			.clock_rate = linux_sim_clock_rate(sim.get_clock),
+			.compress = sim.compress
+		};
+		if (barelog_writer_open(&config) != BARELOG_SUCCESS) {
+			fprintf(stderr, "barelog-sim : cannot open the trace %s\n", sim.prefix);
+			return EXIT_FAILURE;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if ((sim.merge ? barelog_merge_init(NULL, 0)
+			: barelog_drain_start(sim.nb_threads, NULL, consume, NULL, sim.period)) != BARELOG_SUCCESS
+		|| linux_sim_spawn(sim.nb_cores, NULL, core_main, NULL) != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-sim : cannot start the simulation\n");
+		return EXIT_FAILURE;
+	}
+	if (sim.merge) {
+		merged = merge(&drain);
+		barelog_merge_finalize();
+	} else {
+		while (linux_sim_running() > 0) {
+			nanosleep(&period, NULL);
+		}
+	}
+	failed = linux_sim_wait();
+	const double duration = elapsed(&start);
+	if (!sim.merge) {
+		barelog_drain_stop();
+		barelog_drain_stats(&drain);
+	}
+	if (sim.prefix != NULL) {
+		barelog_writer_close();
+		barelog_writer_stats(&writer);
+	}
+
+	for (uint32_t core = 0; core < sim.nb_cores; ++core) {
+		barelog_core_stats_t stats;
+		logged += core_events(core);
+		bad += checks[core].bad;
+		if (barelog_core_stats(core, &stats) != BARELOG_SUCCESS) {
+			fprintf(stderr, "barelog-sim : cannot read the statistics of core %" PRIu32 "\n", core);
+			barelog_host_finalize();
+			return EXIT_FAILURE;
+		}
+		dropped += stats.dropped;
+		overwritten += stats.overwritten;
+		flushed += stats.flushed;
+	}
+	/* Each event logged is either drained or counted as lost by its core.
+	 * The records given back by the memory policy are counted as overwritten
+	 * even if the host was reading them at the same time : these ones are
+	 * then both drained and lost. */
+	const uint64_t lost = dropped + overwritten;
+	const int64_t unaccounted = (int64_t) (logged - drain.events - lost);
+	const uint8_t missing = (sim.memory_policy == SKIP) ? unaccounted != 0 : unaccounted > 0;
+
+	if (sim.json) {
+		printf("{\"cores\": %" PRIu32 ", \"threads\": %" PRIu32 ", \"buffer_policy\": \"%s\","
+			" \"memory_policy\": \"%s\", \"async\": %s, \"ring_size\": %" PRIu32 ", \"chunk_size\": %" PRIu32 ","
+			" \"logged\": %" PRIu64 ", \"drained\": %" PRIu64 ", \"lost\": %" PRIu64 ","
+			" \"dropped\": %" PRIu64 ", \"overwritten\": %" PRIu64 ", \"flushed\": %" PRIu64 ","
+			" \"gaps\": %" PRIu64 ", \"unaccounted\": %" PRId64 ","
+			" \"bad\": %" PRIu64 ", \"failed\": %" PRId32 ", \"bytes\": %" PRIu64 ","
+			" \"written\": %" PRIu64 ", \"seconds\": %.6f, \"events_rate\": %.0f,"
+			" \"bytes_rate\": %.0f}\n",
+			sim.nb_cores, sim.nb_threads, policies[sim.buffer_policy],
+			policies[sim.memory_policy], sim.async ? "true" : "false", sim.ring_size, sim.chunk_size,
+			logged, drain.events, lost, dropped, overwritten, flushed, drain.lost, unaccounted, bad, failed,
+			drain.bytes, writer.events, duration, drain.events / duration,
+			drain.bytes / duration);
+	} else {
+		printf("cores %" PRIu32 ", drain threads %" PRIu32 ", policies %s/%s%s\n",
+			sim.nb_cores, sim.nb_threads, policies[sim.buffer_policy],
+			policies[sim.memory_policy], sim.async ? ", asynchronous flushes" : "");
+		printf("logged %" PRIu64 ", drained %" PRIu64 ", lost %" PRIu64
+			" (dropped %" PRIu64 ", overwritten %" PRIu64 "), flushed %" PRIu64 "\n",
+			logged, drain.events, lost, dropped, overwritten, flushed);
+		printf("gaps seen by the host %" PRIu64 ", unaccounted events %" PRId64 "\n",
+			drain.lost, unaccounted);
+		if (sim.prefix != NULL) {
+			printf("written %" PRIu64 " events into %" PRIu32 " segments\n",
+				writer.events, writer.segments);
+		}
+		printf("%.3f s, %.0f events/s, %.0f bytes/s\n", duration,
+			drain.events / duration, drain.bytes / duration);
+		printf("bad events %" PRIu64 ", failed cores %" PRId32 "\n", bad, failed);
+	}
+
+	barelog_host_finalize();
+
+	if (merged != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-sim : merge error %" PRId8 "\n", merged);
+	}
+
+	return (bad || failed || missing || merged != BARELOG_SUCCESS) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:e:r:k:b:m:f:H:aFt:Mp:w:zc:s:jh")) != -1) {
+		switch (opt) {
+		case 'n':
+			sim.nb_cores = strtoul(optarg, NULL, 0);
+			break;
+		case 'e':
+			sim.events = strtoul(optarg, NULL, 0);
+			break;
+		case 'r':
+			sim.ring_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'k':
+			sim.chunk_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+		case 'm':
+			if (parse_policy(optarg, (opt == 'b') ? &sim.buffer_policy : &sim.memory_policy)) {
+				fprintf(stderr, "barelog-sim : invalid policy %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'f':
+			sim.flush_period = strtoul(optarg, NULL, 0);
+			break;
+		case 'H':
+			sim.hot = strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			sim.async = 1;
+			break;
+		case 'F':
+			sim.format_ids = 1;
+			break;
+		case 't':
+			sim.nb_threads = strtoul(optarg, NULL, 0);
+			break;
+		case 'M':
+			sim.merge = 1;
+			break;
+		case 'p':
+			sim.period = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			sim.prefix = optarg;
+			break;
+		case 'z':
+			sim.compress = 1;
+			break;
+		case 'c':
+			if (!strcmp(optarg, "ns")) {
+				sim.get_clock = linux_sim_clock_ns;
+			} else if (!strcmp(optarg, "tsc")) {
+				sim.get_clock = linux_sim_clock_tsc;
+			} else {
+				fprintf(stderr, "barelog-sim : invalid clock %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 's':
+			sim.shm = optarg;
+			break;
+		case 'j':
+			sim.json = 1;
+			break;
+		case 'h':
+			usage(stdout);
+			return EXIT_SUCCESS;
+		default:
+			usage(stderr);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind != argc || !sim.nb_cores || sim.nb_cores > BARELOG_NB_CORES
+		|| !sim.nb_threads || sim.nb_threads > sim.nb_cores
+		|| (sim.merge && sim.nb_threads != 1)) {
+		usage(stderr);
+		return EXIT_FAILURE;
+	}
+	if (!sim.ring_size) {
+		/* The default memory of the events, shared by the cores. */
+		sim.ring_size = 1;
+		while (sim.ring_size * 2 <= BARELOG_EVENT_SHARED_MEM_MAX / sim.nb_cores) {
+			sim.ring_size *= 2;
+		}
+	}
+
+	/* Upper bound of the memory of the geometry (the pages left untouched
+	 * are never allocated). */
+	const uint64_t length = BARELOG_SHARED_MEM_MAX + (uint64_t) sim.nb_cores * sim.ring_size;
+	if (length > UINT32_MAX || linux_sim_open(sim.shm, length, &sim.platform) != BARELOG_SUCCESS) {
+		fprintf(stderr, "barelog-sim : cannot create the shared memory\n");
+		return EXIT_FAILURE;
+	}
+	const int ret = run();
+	linux_sim_close(sim.shm, &sim.platform);
+
+	return ret;
+}